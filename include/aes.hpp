@@ -5,10 +5,41 @@
 #ifndef AES_HPP
 #define AES_HPP
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define AES_X86
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  else
+#    include <cpuid.h>
+#    include <immintrin.h>
+#  endif
+#endif
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#  define AES_BIG_ENDIAN
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define AES_TARGET(features) __attribute__((target(features)))
+#else
+#  define AES_TARGET(features)
+#endif
+
 namespace aes
 {
     inline namespace detail
@@ -95,48 +126,36 @@ namespace aes
         constexpr std::size_t blockByteCount = 4 * blockWordCount;
         constexpr std::size_t wordByteCount = 4;
 
-        using Word = std::array<std::uint8_t, wordByteCount>;
+        // A column of the state is a 32-bit word holding its four bytes in memory order, so that
+        // blocks are loaded from and stored to bytes without any shuffling. loadColumn gives
+        // the value of the column with the row 0 byte in the lowest bits.
+        using Word = std::uint32_t;
         using Block = std::array<Word, blockWordCount>;
 
         using RoundKey = std::array<Word, 4>;
         template <std::size_t keyLength>
         using RoundKeys = std::array<RoundKey, roundCount<keyLength> + 1>;
 
-        [[nodiscard]] inline Word operator^(const Word& first, const Word& second) noexcept
-        {
-            Word result = first;
-            for (std::size_t i = 0; i < wordByteCount; ++i)
-                result[i] ^= second[i];
-            return result;
-        }
-
-        inline Word& operator^=(Word& first, const Word& second) noexcept
-        {
-            for (std::size_t i = 0; i < wordByteCount; ++i)
-                first[i] ^= second[i];
-            return first;
-        }
-
-        inline void sub(Word& word) noexcept
+        [[nodiscard]] constexpr std::uint32_t swapBytes(const std::uint32_t value) noexcept
         {
-            for (auto& byte : word) byte = sbox[byte];
+            return (value >> 24) | ((value >> 8) & 0xFF00U) | ((value << 8) & 0xFF0000U) | (value << 24);
         }
 
-        inline void intSub(Word& word) noexcept
+        [[nodiscard]] constexpr std::uint32_t loadColumn(const Word word) noexcept
         {
-            for (auto& byte : word) byte = inverseSbox[byte];
+#ifdef AES_BIG_ENDIAN
+            return swapBytes(word);
+#else
+            return word;
+#endif
         }
 
-        inline void rot(Word& word) noexcept
+        constexpr void storeColumn(Word& word, const std::uint32_t column) noexcept
         {
-            const auto c = word[0];
-            word[0] = word[1];
-            word[1] = word[2];
-            word[2] = word[3];
-            word[3] = c;
+            word = loadColumn(column);
         }
 
-        inline std::uint8_t mulBytes(std::uint8_t a, std::uint8_t b) noexcept
+        [[nodiscard]] constexpr std::uint8_t mulBytes(std::uint8_t a, std::uint8_t b) noexcept
         {
             std::uint8_t c = 0;
             for (std::size_t i = 0; i < 8; ++i)
@@ -155,45 +174,123 @@ namespace aes
             return c;
         }
 
+        [[nodiscard]] constexpr std::uint32_t rotateLeft(const std::uint32_t value,
+                                                         const std::uint32_t bits) noexcept
+        {
+            return bits == 0 ? value : (value << bits) | (value >> (32 - bits));
+        }
+
+        // SubWord of a column value
+        [[nodiscard]] constexpr std::uint32_t sub(const std::uint32_t column) noexcept
+        {
+            return static_cast<std::uint32_t>(sbox[column & 0xFFU]) |
+                (static_cast<std::uint32_t>(sbox[(column >> 8) & 0xFFU]) << 8) |
+                (static_cast<std::uint32_t>(sbox[(column >> 16) & 0xFFU]) << 16) |
+                (static_cast<std::uint32_t>(sbox[column >> 24]) << 24);
+        }
+
+        [[nodiscard]] constexpr std::uint32_t invSub(const std::uint32_t column) noexcept
+        {
+            return static_cast<std::uint32_t>(inverseSbox[column & 0xFFU]) |
+                (static_cast<std::uint32_t>(inverseSbox[(column >> 8) & 0xFFU]) << 8) |
+                (static_cast<std::uint32_t>(inverseSbox[(column >> 16) & 0xFFU]) << 16) |
+                (static_cast<std::uint32_t>(inverseSbox[column >> 24]) << 24);
+        }
+
+        // RotWord of a column value, moves every byte one row up
+        [[nodiscard]] constexpr std::uint32_t rot(const std::uint32_t column) noexcept
+        {
+            return rotateLeft(column, 24);
+        }
+
+        // columns are packed into 32-bit words with the row 0 byte in the lowest bits
+        using Table = std::array<std::uint32_t, 256>;
+
+        // SubBytes and MixColumns combined for a byte in row 0, rotated by 8 bits for every next row
+        [[nodiscard]] constexpr Table generateEncryptionTable(const std::uint32_t rotation) noexcept
+        {
+            Table result{};
+            for (std::size_t i = 0; i < result.size(); ++i)
+            {
+                const std::uint8_t s = sbox[i];
+                const std::uint32_t column = static_cast<std::uint32_t>(mulBytes(0x02, s)) |
+                    (static_cast<std::uint32_t>(s) << 8) |
+                    (static_cast<std::uint32_t>(s) << 16) |
+                    (static_cast<std::uint32_t>(mulBytes(0x03, s)) << 24);
+                result[i] = rotateLeft(column, rotation);
+            }
+            return result;
+        }
+
+        constexpr std::array<Table, 4> encryptionTables{
+            generateEncryptionTable(0),
+            generateEncryptionTable(8),
+            generateEncryptionTable(16),
+            generateEncryptionTable(24)
+        };
+
+        // InvSubBytes and InvMixColumns combined for a byte in row 0, rotated by 8 bits for every next row
+        [[nodiscard]] constexpr Table generateDecryptionTable(const std::uint32_t rotation) noexcept
+        {
+            Table result{};
+            for (std::size_t i = 0; i < result.size(); ++i)
+            {
+                const std::uint8_t s = inverseSbox[i];
+                const std::uint32_t column = static_cast<std::uint32_t>(mulBytes(0x0E, s)) |
+                    (static_cast<std::uint32_t>(mulBytes(0x09, s)) << 8) |
+                    (static_cast<std::uint32_t>(mulBytes(0x0D, s)) << 16) |
+                    (static_cast<std::uint32_t>(mulBytes(0x0B, s)) << 24);
+                result[i] = rotateLeft(column, rotation);
+            }
+            return result;
+        }
+
+        constexpr std::array<Table, 4> decryptionTables{
+            generateDecryptionTable(0),
+            generateDecryptionTable(8),
+            generateDecryptionTable(16),
+            generateDecryptionTable(24)
+        };
+
         [[nodiscard]] constexpr std::uint8_t getRoundConstant(std::size_t i) noexcept
         {
             return (i == 1) ? 0x01 : static_cast<std::uint8_t>(0x02 * getRoundConstant(i - 1)) ^ (getRoundConstant(i - 1) >= 0x80 ? 0x1B : 0x00);
         }
 
-        template <std::size_t keyLength, class Key>
-        void expandKey(const Key& key, RoundKeys<keyLength>& roundKeys) noexcept
+        template <std::size_t keyLength, class Key, class Substitute>
+        constexpr void expandKey(const Key& key, RoundKeys<keyLength>& roundKeys, const Substitute& substitute) noexcept
         {
             for (std::size_t i = 0; i < blockWordCount * (roundCount<keyLength> + 1); ++i)
             {
                 if (i < keyWordCount<keyLength>)
-                {
-                    roundKeys[i / 4][i % 4][0] = static_cast<std::uint8_t>(key[i * 4 + 0]);
-                    roundKeys[i / 4][i % 4][1] = static_cast<std::uint8_t>(key[i * 4 + 1]);
-                    roundKeys[i / 4][i % 4][2] = static_cast<std::uint8_t>(key[i * 4 + 2]);
-                    roundKeys[i / 4][i % 4][3] = static_cast<std::uint8_t>(key[i * 4 + 3]);
-                }
+                    storeColumn(roundKeys[i / 4][i % 4],
+                                static_cast<std::uint32_t>(static_cast<std::uint8_t>(key[i * 4 + 0])) |
+                                (static_cast<std::uint32_t>(static_cast<std::uint8_t>(key[i * 4 + 1])) << 8) |
+                                (static_cast<std::uint32_t>(static_cast<std::uint8_t>(key[i * 4 + 2])) << 16) |
+                                (static_cast<std::uint32_t>(static_cast<std::uint8_t>(key[i * 4 + 3])) << 24));
                 else
                 {
                     const std::size_t previousWordIndex = i - 1;
-                    Word temp = roundKeys[previousWordIndex / 4][previousWordIndex % 4];
+                    std::uint32_t temp = loadColumn(roundKeys[previousWordIndex / 4][previousWordIndex % 4]);
 
                     if (i % keyWordCount<keyLength> == 0)
-                    {
-                        rot(temp);
-                        sub(temp);
-                        const Word rCon{getRoundConstant(i / keyWordCount<keyLength>), 0, 0, 0};
-                        temp ^= rCon;
-                    }
+                        temp = substitute(rot(temp)) ^ getRoundConstant(i / keyWordCount<keyLength>);
                     else if (keyWordCount<keyLength> > 6 && i % keyWordCount<keyLength> == 4)
-                        sub(temp);
+                        temp = substitute(temp);
 
                     const std::size_t beforeKeyIndex = i - keyWordCount<keyLength>;
-                    roundKeys[i / 4][i % 4] = roundKeys[beforeKeyIndex / 4][beforeKeyIndex % 4] ^ temp;
+                    storeColumn(roundKeys[i / 4][i % 4], loadColumn(roundKeys[beforeKeyIndex / 4][beforeKeyIndex % 4]) ^ temp);
                 }
             }
         }
 
-        [[nodiscard]] inline Block operator^(const Block& first, const Block& second) noexcept
+        template <std::size_t keyLength, class Key>
+        constexpr void expandKey(const Key& key, RoundKeys<keyLength>& roundKeys) noexcept
+        {
+            expandKey<keyLength>(key, roundKeys, [](const std::uint32_t column) noexcept { return sub(column); });
+        }
+
+        [[nodiscard]] constexpr Block operator^(const Block& first, const Block& second) noexcept
         {
             Block result = first;
             for (std::size_t i = 0; i < blockWordCount; ++i)
@@ -202,7 +299,7 @@ namespace aes
             return result;
         }
 
-        inline Block& operator^=(Block& first, const Block& second) noexcept
+        constexpr Block& operator^=(Block& first, const Block& second) noexcept
         {
             for (std::size_t i = 0; i < blockWordCount; ++i)
                 first[i] ^= second[i];
@@ -210,101 +307,90 @@ namespace aes
             return first;
         }
 
-        inline void subBytes(Block& block) noexcept
+        // The reference rounds work on the column values of the state, ShiftRows takes row r
+        // of every column from the column r places further on.
+
+        inline void subBytes(Block& state) noexcept
         {
-            for (std::size_t i = 0; i < wordByteCount; ++i)
-                sub(block[i]);
+            for (auto& column : state)
+                column = sub(column);
         }
 
-        inline void invSubBytes(Block& block) noexcept
+        inline void invSubBytes(Block& state) noexcept
         {
-            for (std::size_t i = 0; i < wordByteCount; ++i)
-                intSub(block[i]);
+            for (auto& column : state)
+                column = invSub(column);
         }
 
-        inline void shiftRow(Block& block, const std::size_t i, const std::size_t n) noexcept
+        inline void shiftRows(Block& state) noexcept
         {
-            for (std::size_t k = 0; k < n; k++)
-                rot(block[i]);
+            const Block s = state;
+            for (std::size_t j = 0; j < blockWordCount; ++j)
+                state[j] = (s[j] & 0x000000FFU) |
+                    (s[(j + 1) % blockWordCount] & 0x0000FF00U) |
+                    (s[(j + 2) % blockWordCount] & 0x00FF0000U) |
+                    (s[(j + 3) % blockWordCount] & 0xFF000000U);
         }
 
-        inline void shiftRows(Block& block) noexcept
+        inline void invShiftRows(Block& state) noexcept
         {
-            shiftRow(block, 1, 1);
-            shiftRow(block, 2, 2);
-            shiftRow(block, 3, 3);
+            const Block s = state;
+            for (std::size_t j = 0; j < blockWordCount; ++j)
+                state[j] = (s[j] & 0x000000FFU) |
+                    (s[(j + 3) % blockWordCount] & 0x0000FF00U) |
+                    (s[(j + 2) % blockWordCount] & 0x00FF0000U) |
+                    (s[(j + 1) % blockWordCount] & 0xFF000000U);
         }
 
-        inline void invShiftRows(Block& block) noexcept
+        // multiplies all four bytes of the column by x
+        [[nodiscard]] constexpr std::uint32_t mulColumn(const std::uint32_t column) noexcept
         {
-            shiftRow(block, 1, blockWordCount - 1);
-            shiftRow(block, 2, blockWordCount - 2);
-            shiftRow(block, 3, blockWordCount - 3);
+            return ((column & 0x7F7F7F7FU) << 1) ^ (((column >> 7) & 0x01010101U) * 0x1BU);
         }
 
-        inline void mixColumns(Block& block) noexcept
+        // 2 * a[r] ^ 3 * a[r + 1] ^ a[r + 2] ^ a[r + 3]
+        [[nodiscard]] constexpr std::uint32_t mixColumnBytes(const std::uint32_t column) noexcept
         {
-            for (std::size_t j = 0; j < blockWordCount; ++j)
-            {
-                const Word s{
-                    block[0][j],
-                    block[1][j],
-                    block[2][j],
-                    block[3][j]
-                };
+            const std::uint32_t rotated = rotateLeft(column, 24);
+            return mulColumn(column ^ rotated) ^ rotated ^ rotateLeft(column, 16) ^ rotateLeft(column, 8);
+        }
 
-                const Word s1{
-                    static_cast<std::uint8_t>(mulBytes(0x02, s[0]) ^ mulBytes(0x03, s[1]) ^ s[2] ^ s[3]),
-                    static_cast<std::uint8_t>(s[0] ^ mulBytes(0x02, s[1]) ^ mulBytes(0x03, s[2]) ^ s[3]),
-                    static_cast<std::uint8_t>(s[0] ^ s[1] ^ mulBytes(0x02, s[2]) ^ mulBytes(0x03, s[3])),
-                    static_cast<std::uint8_t>(mulBytes(0x03, s[0]) ^ s[1] ^ s[2] ^ mulBytes(0x02, s[3]))
-                };
+        inline void mixColumns(Block& state) noexcept
+        {
+            for (auto& column : state)
+                column = mixColumnBytes(column);
+        }
 
-                for (std::size_t i = 0; i < wordByteCount; ++i)
-                    block[i][j] = s1[i];
-          }
+        // the InvMixColumns matrix is the MixColumns matrix times {05 00 04 00}
+        inline void invMixColumns(Block& state) noexcept
+        {
+            for (auto& column : state)
+                column = mixColumnBytes(column ^ mulColumn(mulColumn(column ^ rotateLeft(column, 16))));
         }
 
-        inline void invMixColumns(Block& block) noexcept
+        inline void addRoundKey(Block& state, const RoundKey& roundKey) noexcept
         {
             for (std::size_t j = 0; j < blockWordCount; ++j)
-            {
-                const Word s{
-                    block[0][j],
-                    block[1][j],
-                    block[2][j],
-                    block[3][j]
-                };
-
-                const Word s1{
-                    static_cast<std::uint8_t>(mulBytes(0x0E, s[0]) ^ mulBytes(0x0B, s[1]) ^ mulBytes(0x0D, s[2]) ^ mulBytes(0x09, s[3])),
-                    static_cast<std::uint8_t>(mulBytes(0x09, s[0]) ^ mulBytes(0x0E, s[1]) ^ mulBytes(0x0B, s[2]) ^ mulBytes(0x0D, s[3])),
-                    static_cast<std::uint8_t>(mulBytes(0x0D, s[0]) ^ mulBytes(0x09, s[1]) ^ mulBytes(0x0E, s[2]) ^ mulBytes(0x0B, s[3])),
-                    static_cast<std::uint8_t>(mulBytes(0x0B, s[0]) ^ mulBytes(0x0D, s[1]) ^ mulBytes(0x09, s[2]) ^ mulBytes(0x0E, s[3]))
-                };
-
-                for (std::size_t i = 0; i < wordByteCount; ++i)
-                    block[i][j] = s1[i];
-            }
+                state[j] ^= loadColumn(roundKey[j]);
         }
 
-        inline void addRoundKey(Block& block, const RoundKey& roundKey) noexcept
+        inline void loadState(Block& state, const Block& block) noexcept
         {
-            for (std::size_t i = 0; i < blockWordCount; ++i)
-                for (std::size_t j = 0; j < wordByteCount; ++j)
-                    block[i][j] ^= roundKey[j][i];
+            for (std::size_t j = 0; j < blockWordCount; ++j)
+                state[j] = loadColumn(block[j]);
         }
 
-        template <std::size_t keyLength, class Key>
-        void encrypt(Block& block, const Key& key) noexcept
+        inline void storeState(Block& block, const Block& state) noexcept
         {
-            RoundKeys<keyLength> roundKeys;
-            expandKey<keyLength>(key, roundKeys);
+            for (std::size_t j = 0; j < blockWordCount; ++j)
+                storeColumn(block[j], state[j]);
+        }
 
+        template <std::size_t keyLength>
+        void encryptBlock(Block& block, const RoundKeys<keyLength>& roundKeys) noexcept
+        {
             Block state;
-            for (std::size_t i = 0; i < wordByteCount; ++i)
-                for (std::size_t j = 0; j < blockWordCount; ++j)
-                    state[i][j] = block[j][i];
+            loadState(state, block);
 
             addRoundKey(state, roundKeys[0]);
 
@@ -320,21 +406,14 @@ namespace aes
             shiftRows(state);
             addRoundKey(state, roundKeys[roundCount<keyLength>]);
 
-            for (std::size_t i = 0; i < wordByteCount; ++i)
-                for (std::size_t j = 0; j < blockWordCount; ++j)
-                    block[j][i] = state[i][j];
+            storeState(block, state);
         }
 
-        template <std::size_t keyLength, class Key>
-        void decrypt(Block& block, const Key& key) noexcept
+        template <std::size_t keyLength>
+        void decryptBlock(Block& block, const RoundKeys<keyLength>& roundKeys) noexcept
         {
-            RoundKeys<keyLength> roundKeys;
-            expandKey<keyLength>(key, roundKeys);
-
             Block state;
-            for (std::size_t i = 0; i < wordByteCount; ++i)
-                for (std::size_t j = 0; j < blockWordCount; ++j)
-                    state[i][j] = block[j][i];
+            loadState(state, block);
 
             addRoundKey(state, roundKeys[roundCount<keyLength>]);
 
@@ -350,252 +429,3233 @@ namespace aes
             invShiftRows(state);
             addRoundKey(state, roundKeys[0]);
 
-            for (std::size_t i = 0; i < wordByteCount; ++i)
-                for (std::size_t j = 0; j < blockWordCount; ++j)
-                    block[j][i] = state[i][j];
+            storeState(block, state);
         }
 
-        template <class Iterator>
-        [[nodiscard]]
-        std::vector<Block> convertToBlocks(Iterator begin, Iterator end)
+        [[nodiscard]] constexpr std::uint32_t subColumn(const std::uint32_t a, const std::uint32_t b,
+                                                        const std::uint32_t c, const std::uint32_t d) noexcept
         {
-            std::vector<Block> result;
+            return static_cast<std::uint32_t>(sbox[a & 0xFFU]) |
+                (static_cast<std::uint32_t>(sbox[(b >> 8) & 0xFFU]) << 8) |
+                (static_cast<std::uint32_t>(sbox[(c >> 16) & 0xFFU]) << 16) |
+                (static_cast<std::uint32_t>(sbox[d >> 24]) << 24);
+        }
 
-            std::size_t byte = 0;
-            for (auto i = begin; i != end; ++i)
-            {
-                if (result.size() < byte / blockByteCount + 1)
-                    result.resize(byte / blockByteCount + 1);
+        [[nodiscard]] constexpr std::uint32_t mixColumn(const std::uint32_t a, const std::uint32_t b,
+                                                        const std::uint32_t c, const std::uint32_t d) noexcept
+        {
+            return encryptionTables[0][a & 0xFFU] ^
+                encryptionTables[1][(b >> 8) & 0xFFU] ^
+                encryptionTables[2][(c >> 16) & 0xFFU] ^
+                encryptionTables[3][d >> 24];
+        }
+
+        // encrypts the block with the SubBytes, ShiftRows and MixColumns steps looked up from the tables
+        template <std::size_t keyLength>
+        constexpr void encryptBlockTable(Block& block, const RoundKeys<keyLength>& roundKeys) noexcept
+        {
+            std::uint32_t s0 = loadColumn(block[0]) ^ loadColumn(roundKeys[0][0]);
+            std::uint32_t s1 = loadColumn(block[1]) ^ loadColumn(roundKeys[0][1]);
+            std::uint32_t s2 = loadColumn(block[2]) ^ loadColumn(roundKeys[0][2]);
+            std::uint32_t s3 = loadColumn(block[3]) ^ loadColumn(roundKeys[0][3]);
 
-                Block& block = result[byte / blockByteCount];
-                Word& word = block[(byte / wordByteCount) % blockWordCount];
-                word[byte % wordByteCount] = static_cast<std::uint8_t>(*i);
-                ++byte;
+            for (std::size_t round = 1; round <= roundCount<keyLength> - 1; ++round)
+            {
+                const std::uint32_t t0 = mixColumn(s0, s1, s2, s3) ^ loadColumn(roundKeys[round][0]);
+                const std::uint32_t t1 = mixColumn(s1, s2, s3, s0) ^ loadColumn(roundKeys[round][1]);
+                const std::uint32_t t2 = mixColumn(s2, s3, s0, s1) ^ loadColumn(roundKeys[round][2]);
+                const std::uint32_t t3 = mixColumn(s3, s0, s1, s2) ^ loadColumn(roundKeys[round][3]);
+                s0 = t0;
+                s1 = t1;
+                s2 = t2;
+                s3 = t3;
             }
 
-            return result;
+            const auto& lastRoundKey = roundKeys[roundCount<keyLength>];
+            storeColumn(block[0], subColumn(s0, s1, s2, s3) ^ loadColumn(lastRoundKey[0]));
+            storeColumn(block[1], subColumn(s1, s2, s3, s0) ^ loadColumn(lastRoundKey[1]));
+            storeColumn(block[2], subColumn(s2, s3, s0, s1) ^ loadColumn(lastRoundKey[2]));
+            storeColumn(block[3], subColumn(s3, s0, s1, s2) ^ loadColumn(lastRoundKey[3]));
         }
-    }
 
-    template <std::size_t keyLength, class Iterator, class Key>
-    [[nodiscard]]
-    std::vector<std::uint8_t> encryptEcb(Iterator begin, Iterator end, const Key& key)
-    {
-        auto blocks = convertToBlocks(begin, end);
-        std::vector<std::uint8_t> result(blocks.size() * blockByteCount);
+        [[nodiscard]] constexpr std::uint32_t invSubColumn(const std::uint32_t a, const std::uint32_t b,
+                                                           const std::uint32_t c, const std::uint32_t d) noexcept
+        {
+            return static_cast<std::uint32_t>(inverseSbox[a & 0xFFU]) |
+                (static_cast<std::uint32_t>(inverseSbox[(b >> 8) & 0xFFU]) << 8) |
+                (static_cast<std::uint32_t>(inverseSbox[(c >> 16) & 0xFFU]) << 16) |
+                (static_cast<std::uint32_t>(inverseSbox[d >> 24]) << 24);
+        }
 
-        auto resultIterator = result.begin();
+        [[nodiscard]] constexpr std::uint32_t invMixColumn(const std::uint32_t a, const std::uint32_t b,
+                                                           const std::uint32_t c, const std::uint32_t d) noexcept
+        {
+            return decryptionTables[0][a & 0xFFU] ^
+                decryptionTables[1][(b >> 8) & 0xFFU] ^
+                decryptionTables[2][(c >> 16) & 0xFFU] ^
+                decryptionTables[3][d >> 24];
+        }
 
-        for (auto& block : blocks)
+        // round keys for the equivalent inverse cipher (FIPS-197 section 5.3.5):
+        // the encryption round keys in reverse order with InvMixColumns applied to all but the first and the last
+        template <std::size_t keyLength>
+        constexpr void invertRoundKeys(const RoundKeys<keyLength>& roundKeys,
+                                       RoundKeys<keyLength>& decryptionRoundKeys) noexcept
         {
-            encrypt<keyLength>(block, key);
+            decryptionRoundKeys[0] = roundKeys[roundCount<keyLength>];
+
+            for (std::size_t round = 1; round < roundCount<keyLength>; ++round)
+                for (std::size_t i = 0; i < blockWordCount; ++i)
+                {
+                    const std::uint32_t column = loadColumn(roundKeys[roundCount<keyLength> - round][i]);
+                    // the decryption tables include InvSubBytes, so cancel it out with SubBytes
+                    storeColumn(decryptionRoundKeys[round][i],
+                                decryptionTables[0][sbox[column & 0xFFU]] ^
+                                decryptionTables[1][sbox[(column >> 8) & 0xFFU]] ^
+                                decryptionTables[2][sbox[(column >> 16) & 0xFFU]] ^
+                                decryptionTables[3][sbox[column >> 24]]);
+                }
 
-            // copy the block to output
-            for (const auto w : block)
-                for (const auto b : w)
-                    *resultIterator++ = b;
+            decryptionRoundKeys[roundCount<keyLength>] = roundKeys[0];
         }
 
-        return result;
-    }
+        // decrypts the block with the equivalent inverse cipher, InvShiftRows shifts the rows the other way
+        template <std::size_t keyLength>
+        constexpr void decryptBlockTable(Block& block, const RoundKeys<keyLength>& decryptionRoundKeys) noexcept
+        {
+            std::uint32_t s0 = loadColumn(block[0]) ^ loadColumn(decryptionRoundKeys[0][0]);
+            std::uint32_t s1 = loadColumn(block[1]) ^ loadColumn(decryptionRoundKeys[0][1]);
+            std::uint32_t s2 = loadColumn(block[2]) ^ loadColumn(decryptionRoundKeys[0][2]);
+            std::uint32_t s3 = loadColumn(block[3]) ^ loadColumn(decryptionRoundKeys[0][3]);
 
-    template <std::size_t keyLength, class Data, class Key>
-    [[nodiscard]]
-    std::vector<std::uint8_t> encryptEcb(const Data& data, const Key& key)
-    {
-        using std::begin, std::end; // add std::begin and std::end to lookup
-        return encryptEcb<keyLength>(begin(data), end(data), key);
-    }
+            for (std::size_t round = 1; round <= roundCount<keyLength> - 1; ++round)
+            {
+                const std::uint32_t t0 = invMixColumn(s0, s3, s2, s1) ^ loadColumn(decryptionRoundKeys[round][0]);
+                const std::uint32_t t1 = invMixColumn(s1, s0, s3, s2) ^ loadColumn(decryptionRoundKeys[round][1]);
+                const std::uint32_t t2 = invMixColumn(s2, s1, s0, s3) ^ loadColumn(decryptionRoundKeys[round][2]);
+                const std::uint32_t t3 = invMixColumn(s3, s2, s1, s0) ^ loadColumn(decryptionRoundKeys[round][3]);
+                s0 = t0;
+                s1 = t1;
+                s2 = t2;
+                s3 = t3;
+            }
 
-    template <std::size_t keyLength, class Iterator, class Key>
-    [[nodiscard]]
-    std::vector<std::uint8_t> decryptEcb(Iterator begin, Iterator end, const Key& key)
-    {
-        auto blocks = convertToBlocks(begin, end);
-        std::vector<std::uint8_t> result(blocks.size() * blockByteCount);
+            const auto& lastRoundKey = decryptionRoundKeys[roundCount<keyLength>];
+            storeColumn(block[0], invSubColumn(s0, s3, s2, s1) ^ loadColumn(lastRoundKey[0]));
+            storeColumn(block[1], invSubColumn(s1, s0, s3, s2) ^ loadColumn(lastRoundKey[1]));
+            storeColumn(block[2], invSubColumn(s2, s1, s0, s3) ^ loadColumn(lastRoundKey[2]));
+            storeColumn(block[3], invSubColumn(s3, s2, s1, s0) ^ loadColumn(lastRoundKey[3]));
+        }
+
+        // number of blocks encrypted together to keep the AES units busy
+        constexpr std::size_t parallelBlockCount = 8;
 
-        auto resultIterator = result.begin();
+        using BlockBytes = std::array<std::uint8_t, blockByteCount>;
 
-        for (auto& block : blocks)
+        // a message of the multi-buffer functions, the output needs room for getPaddedSize(size) bytes
+        // in the block modes and may be the input, the initialization vector is not used by ECB
+        struct Job final
         {
-            decrypt<keyLength, Key>(block, key);
+            const std::uint8_t* key = nullptr;
+            const std::uint8_t* initVector = nullptr;
+            const std::uint8_t* input = nullptr;
+            std::size_t size = 0;
+            std::uint8_t* output = nullptr;
+        };
 
-            // copy the block to output
-            for (const auto word : block)
-                for (const auto byte : word)
-                    *resultIterator++ = byte;
-        }
+        // a message with the tag to verify
+        struct CmacJob final
+        {
+            const std::uint8_t* input = nullptr;
+            std::size_t size = 0;
+            const std::uint8_t* tag = nullptr;
+        };
 
-        return result;
-    }
+        // blocks and round keys are accessed as contiguous bytes
+        static_assert(sizeof(RoundKey) == blockByteCount && sizeof(Block) == blockByteCount);
 
-    template <std::size_t keyLength, class Data, class Key>
-    [[nodiscard]]
-    std::vector<std::uint8_t> decryptEcb(const Data& data, const Key& key)
-    {
-        using std::begin, std::end; // add std::begin and std::end to lookup
-        return decryptEcb<keyLength>(begin(data), end(data), key);
-    }
+        // Bitsliced state of parallelBlockCount blocks, the bit planes are indexed by [half * 8 + bit].
+        // Bit k of byte i of a plane is the bit of byte i of block k and each of the two halves
+        // holds two columns, so that the rows of a column are the bytes of a 32-bit lane.
+        using BitslicedState = std::array<std::uint64_t, 16>;
 
-    template <std::size_t keyLength, class Iterator, class Key, class InitVector>
-    [[nodiscard]]
-    std::vector<std::uint8_t> encryptCbc(Iterator begin, Iterator end, const Key& key,
-                                         const InitVector& initVector)
-    {
-        const auto blocks = convertToBlocks(begin, end);
-        std::vector<std::uint8_t> result(blocks.size() * blockByteCount);
+        template <std::size_t keyLength>
+        using BitslicedRoundKeys = std::array<BitslicedState, roundCount<keyLength> + 1>;
 
-        Block dataBlock;
+        static_assert(parallelBlockCount == 8, "The bitsliced bytes hold a bit of each block");
 
-        auto initVectorIterator = std::begin(initVector);
-        for (auto& w : dataBlock)
-            for (auto& b : w)
-                b = *initVectorIterator++;
+        // exchanges the bits of a selected by the mask shifted left with the bits of b selected by the mask
+        inline void swapMove(std::uint64_t& a, std::uint64_t& b, const std::uint64_t mask, const unsigned int shift) noexcept
+        {
+            const std::uint64_t t = ((a >> shift) ^ b) & mask;
+            b ^= t;
+            a ^= t << shift;
+        }
 
-        auto resultIterator = result.begin();
+        // transposes the 8x8 bit matrices of every byte lane, bit i of word k is swapped with bit k of word i
+        inline void transposeLanes(std::uint64_t* q) noexcept
+        {
+            swapMove(q[0], q[1], 0x5555555555555555U, 1);
+            swapMove(q[2], q[3], 0x5555555555555555U, 1);
+            swapMove(q[4], q[5], 0x5555555555555555U, 1);
+            swapMove(q[6], q[7], 0x5555555555555555U, 1);
+
+            swapMove(q[0], q[2], 0x3333333333333333U, 2);
+            swapMove(q[1], q[3], 0x3333333333333333U, 2);
+            swapMove(q[4], q[6], 0x3333333333333333U, 2);
+            swapMove(q[5], q[7], 0x3333333333333333U, 2);
+
+            swapMove(q[0], q[4], 0x0F0F0F0F0F0F0F0FU, 4);
+            swapMove(q[1], q[5], 0x0F0F0F0F0F0F0F0FU, 4);
+            swapMove(q[2], q[6], 0x0F0F0F0F0F0F0F0FU, 4);
+            swapMove(q[3], q[7], 0x0F0F0F0F0F0F0F0FU, 4);
+        }
 
-        for (const auto& block : blocks)
+        inline void bitslice(const Block* blocks, BitslicedState& state) noexcept
         {
-            dataBlock ^= block;
-            encrypt<keyLength>(dataBlock, key);
+            for (std::size_t k = 0; k < parallelBlockCount; ++k)
+            {
+                state[k] = loadColumn(blocks[k][0]) | (static_cast<std::uint64_t>(loadColumn(blocks[k][1])) << 32);
+                state[k + 8] = loadColumn(blocks[k][2]) | (static_cast<std::uint64_t>(loadColumn(blocks[k][3])) << 32);
+            }
 
-            // copy the block to output
-            for (const auto w : dataBlock)
-                for (const auto b : w)
-                    *resultIterator++ = b;
+            transposeLanes(state.data());
+            transposeLanes(state.data() + 8);
         }
 
-        return result;
-    }
+        inline void unbitslice(BitslicedState state, Block* blocks) noexcept
+        {
+            transposeLanes(state.data());
+            transposeLanes(state.data() + 8);
 
-    template <std::size_t keyLength, class Data, class Key, class InitVector>
-    [[nodiscard]]
-    std::vector<std::uint8_t> encryptCbc(const Data& data, const Key& key,
-                                         const InitVector& initVector)
-    {
-        using std::begin, std::end; // add std::begin and std::end to lookup
-        return encryptCbc<keyLength>(begin(data), end(data), key, initVector);
-    }
+            for (std::size_t k = 0; k < parallelBlockCount; ++k)
+            {
+                storeColumn(blocks[k][0], static_cast<std::uint32_t>(state[k]));
+                storeColumn(blocks[k][1], static_cast<std::uint32_t>(state[k] >> 32));
+                storeColumn(blocks[k][2], static_cast<std::uint32_t>(state[k + 8]));
+                storeColumn(blocks[k][3], static_cast<std::uint32_t>(state[k + 8] >> 32));
+            }
+        }
 
-    template <std::size_t keyLength, class Iterator, class Key, class InitVector>
-    [[nodiscard]]
-    std::vector<std::uint8_t> decryptCbc(Iterator begin, Iterator end, const Key& key,
-                                         const InitVector& initVector)
-    {
-        auto blocks = convertToBlocks(begin, end);
-        std::vector<std::uint8_t> result(blocks.size() * blockByteCount);
+        // S-box as the circuit of Boyar and Peralta, q[i] is the plane of bit i
+        inline void subBytesBitsliced(std::uint64_t* q) noexcept
+        {
+            const std::uint64_t x0 = q[7];
+            const std::uint64_t x1 = q[6];
+            const std::uint64_t x2 = q[5];
+            const std::uint64_t x3 = q[4];
+            const std::uint64_t x4 = q[3];
+            const std::uint64_t x5 = q[2];
+            const std::uint64_t x6 = q[1];
+            const std::uint64_t x7 = q[0];
+
+            // top linear transformation
+            const std::uint64_t y14 = x3 ^ x5;
+            const std::uint64_t y13 = x0 ^ x6;
+            const std::uint64_t y9 = x0 ^ x3;
+            const std::uint64_t y8 = x0 ^ x5;
+            const std::uint64_t t0 = x1 ^ x2;
+            const std::uint64_t y1 = t0 ^ x7;
+            const std::uint64_t y4 = y1 ^ x3;
+            const std::uint64_t y12 = y13 ^ y14;
+            const std::uint64_t y2 = y1 ^ x0;
+            const std::uint64_t y5 = y1 ^ x6;
+            const std::uint64_t y3 = y5 ^ y8;
+            const std::uint64_t t1 = x4 ^ y12;
+            const std::uint64_t y15 = t1 ^ x5;
+            const std::uint64_t y20 = t1 ^ x1;
+            const std::uint64_t y6 = y15 ^ x7;
+            const std::uint64_t y10 = y15 ^ t0;
+            const std::uint64_t y11 = y20 ^ y9;
+            const std::uint64_t y7 = x7 ^ y11;
+            const std::uint64_t y17 = y10 ^ y11;
+            const std::uint64_t y19 = y10 ^ y8;
+            const std::uint64_t y16 = t0 ^ y11;
+            const std::uint64_t y21 = y13 ^ y16;
+            const std::uint64_t y18 = x0 ^ y16;
+
+            // non-linear section
+            const std::uint64_t t2 = y12 & y15;
+            const std::uint64_t t3 = y3 & y6;
+            const std::uint64_t t4 = t3 ^ t2;
+            const std::uint64_t t5 = y4 & x7;
+            const std::uint64_t t6 = t5 ^ t2;
+            const std::uint64_t t7 = y13 & y16;
+            const std::uint64_t t8 = y5 & y1;
+            const std::uint64_t t9 = t8 ^ t7;
+            const std::uint64_t t10 = y2 & y7;
+            const std::uint64_t t11 = t10 ^ t7;
+            const std::uint64_t t12 = y9 & y11;
+            const std::uint64_t t13 = y14 & y17;
+            const std::uint64_t t14 = t13 ^ t12;
+            const std::uint64_t t15 = y8 & y10;
+            const std::uint64_t t16 = t15 ^ t12;
+            const std::uint64_t t17 = t4 ^ t14;
+            const std::uint64_t t18 = t6 ^ t16;
+            const std::uint64_t t19 = t9 ^ t14;
+            const std::uint64_t t20 = t11 ^ t16;
+            const std::uint64_t t21 = t17 ^ y20;
+            const std::uint64_t t22 = t18 ^ y19;
+            const std::uint64_t t23 = t19 ^ y21;
+            const std::uint64_t t24 = t20 ^ y18;
+
+            const std::uint64_t t25 = t21 ^ t22;
+            const std::uint64_t t26 = t21 & t23;
+            const std::uint64_t t27 = t24 ^ t26;
+            const std::uint64_t t28 = t25 & t27;
+            const std::uint64_t t29 = t28 ^ t22;
+            const std::uint64_t t30 = t23 ^ t24;
+            const std::uint64_t t31 = t22 ^ t26;
+            const std::uint64_t t32 = t31 & t30;
+            const std::uint64_t t33 = t32 ^ t24;
+            const std::uint64_t t34 = t23 ^ t33;
+            const std::uint64_t t35 = t27 ^ t33;
+            const std::uint64_t t36 = t24 & t35;
+            const std::uint64_t t37 = t36 ^ t34;
+            const std::uint64_t t38 = t27 ^ t36;
+            const std::uint64_t t39 = t29 & t38;
+            const std::uint64_t t40 = t25 ^ t39;
+
+            const std::uint64_t t41 = t40 ^ t37;
+            const std::uint64_t t42 = t29 ^ t33;
+            const std::uint64_t t43 = t29 ^ t40;
+            const std::uint64_t t44 = t33 ^ t37;
+            const std::uint64_t t45 = t42 ^ t41;
+            const std::uint64_t z0 = t44 & y15;
+            const std::uint64_t z1 = t37 & y6;
+            const std::uint64_t z2 = t33 & x7;
+            const std::uint64_t z3 = t43 & y16;
+            const std::uint64_t z4 = t40 & y1;
+            const std::uint64_t z5 = t29 & y7;
+            const std::uint64_t z6 = t42 & y11;
+            const std::uint64_t z7 = t45 & y17;
+            const std::uint64_t z8 = t41 & y10;
+            const std::uint64_t z9 = t44 & y12;
+            const std::uint64_t z10 = t37 & y3;
+            const std::uint64_t z11 = t33 & y4;
+            const std::uint64_t z12 = t43 & y13;
+            const std::uint64_t z13 = t40 & y5;
+            const std::uint64_t z14 = t29 & y2;
+            const std::uint64_t z15 = t42 & y9;
+            const std::uint64_t z16 = t45 & y14;
+            const std::uint64_t z17 = t41 & y8;
+
+            // bottom linear transformation
+            const std::uint64_t t46 = z15 ^ z16;
+            const std::uint64_t t47 = z10 ^ z11;
+            const std::uint64_t t48 = z5 ^ z13;
+            const std::uint64_t t49 = z9 ^ z10;
+            const std::uint64_t t50 = z2 ^ z12;
+            const std::uint64_t t51 = z2 ^ z5;
+            const std::uint64_t t52 = z7 ^ z8;
+            const std::uint64_t t53 = z0 ^ z3;
+            const std::uint64_t t54 = z6 ^ z7;
+            const std::uint64_t t55 = z16 ^ z17;
+            const std::uint64_t t56 = z12 ^ t48;
+            const std::uint64_t t57 = t50 ^ t53;
+            const std::uint64_t t58 = z4 ^ t46;
+            const std::uint64_t t59 = z3 ^ t54;
+            const std::uint64_t t60 = t46 ^ t57;
+            const std::uint64_t t61 = z14 ^ t57;
+            const std::uint64_t t62 = t52 ^ t58;
+            const std::uint64_t t63 = t49 ^ t58;
+            const std::uint64_t t64 = z4 ^ t59;
+            const std::uint64_t t65 = t61 ^ t62;
+            const std::uint64_t t66 = z1 ^ t63;
+            const std::uint64_t t67 = t64 ^ t65;
+
+            q[7] = t59 ^ t63;
+            q[1] = t56 ^ ~t62;
+            q[0] = t48 ^ ~t60;
+            q[4] = t53 ^ t66;
+            q[3] = t51 ^ t66;
+            q[2] = t47 ^ t65;
+            q[6] = t64 ^ ~q[4];
+            q[5] = t55 ^ ~t67;
+        }
 
-        Block dataBlock;
+        // inverse affine transformation of the S-box, S^-1(x) = A^-1(S(A^-1(x)))
+        inline void invAffineBitsliced(std::uint64_t* q) noexcept
+        {
+            const std::array<std::uint64_t, 8> x{q[0], q[1], q[2], q[3], q[4], q[5], q[6], q[7]};
+            for (std::size_t i = 0; i < 8; ++i)
+                q[i] = x[(i + 2) % 8] ^ x[(i + 5) % 8] ^ x[(i + 7) % 8];
 
-        auto initVectorIterator = std::begin(initVector);
-        for (auto& w : dataBlock)
-            for (auto& b : w)
-                b = *initVectorIterator++;
+            // constant 0x05
+            q[0] = ~q[0];
+            q[2] = ~q[2];
+        }
 
-        auto dataIterator = begin;
-        auto resultIterator = result.begin();
+        inline void invSubBytesBitsliced(std::uint64_t* q) noexcept
+        {
+            invAffineBitsliced(q);
+            subBytesBitsliced(q);
+            invAffineBitsliced(q);
+        }
 
-        for (auto& block : blocks)
+        // moves the bytes of each row by the row index to the left, or to the right for the inverse
+        template <bool inverse>
+        void shiftRowsBitsliced(BitslicedState& state) noexcept
         {
-            decrypt<keyLength>(block, key);
-            block ^= dataBlock;
+            constexpr std::uint64_t row0 = 0x000000FF000000FFU;
+            constexpr std::uint64_t row1 = row0 << 8;
+            constexpr std::uint64_t row2 = row0 << 16;
+            constexpr std::uint64_t row3 = row0 << 24;
 
-            // copy the block to output
-            for (const auto w : block)
-                for (const auto b : w)
-                    *resultIterator++ = b;
+            for (std::size_t bit = 0; bit < 8; ++bit)
+            {
+                const std::uint64_t low = state[bit];
+                const std::uint64_t high = state[bit + 8];
+                const std::uint64_t next = (low >> 32) | (high << 32); // columns 1 and 2
+                const std::uint64_t previous = (high >> 32) | (low << 32); // columns 3 and 0
+                const std::uint64_t left = inverse ? previous : next;
+                const std::uint64_t right = inverse ? next : previous;
+
+                state[bit] = (low & row0) | (left & row1) | (high & row2) | (right & row3);
+                state[bit + 8] = (high & row0) | (right & row1) | (low & row2) | (left & row3);
+            }
+        }
 
-            // copy the data to data block
-            for (auto& w : dataBlock)
-                for (auto& b : w)
-                    b = *dataIterator++;
+        // rotates the rows of the columns up by one or two
+        constexpr std::uint64_t rotateRows1(const std::uint64_t x) noexcept
+        {
+            return ((x >> 8) & 0x00FFFFFF00FFFFFFU) | ((x << 24) & 0xFF000000FF000000U);
         }
 
-        return result;
-    }
+        constexpr std::uint64_t rotateRows2(const std::uint64_t x) noexcept
+        {
+            return ((x >> 16) & 0x0000FFFF0000FFFFU) | ((x << 16) & 0xFFFF0000FFFF0000U);
+        }
 
-    template <std::size_t keyLength, class Data, class Key, class InitVector>
-    [[nodiscard]]
-    std::vector<std::uint8_t> decryptCbc(const Data& data, const Key& key,
-                                         const InitVector& initVector)
-    {
-        using std::begin, std::end; // add std::begin and std::end to lookup
-        return decryptCbc<keyLength>(begin(data), end(data), key, initVector);
-    }
+        // multiplication of the bitsliced bytes by x modulo x^8 + x^4 + x^3 + x + 1
+        inline void mulBitsliced(std::uint64_t* q) noexcept
+        {
+            const std::uint64_t carry = q[7];
+            q[7] = q[6];
+            q[6] = q[5];
+            q[5] = q[4];
+            q[4] = q[3] ^ carry;
+            q[3] = q[2] ^ carry;
+            q[2] = q[1];
+            q[1] = q[0] ^ carry;
+            q[0] = carry;
+        }
 
-    template <std::size_t keyLength, class Iterator, class Key, class InitVector>
-    [[nodiscard]]
-    std::vector<std::uint8_t> encryptCfb(Iterator begin, Iterator end, const Key& key,
-                                         const InitVector& initVector)
-    {
-        const auto blocks = convertToBlocks(begin, end);
-        std::vector<std::uint8_t> result(blocks.size() * blockByteCount);
+        // 2a[r] ^ 3a[r + 1] ^ a[r + 2] ^ a[r + 3] as 2(a[r] ^ a[r + 1]) ^ a[r + 1] ^ (a[r + 2] ^ a[r + 3])
+        inline void mixColumnsBitsliced(BitslicedState& state) noexcept
+        {
+            for (std::size_t half = 0; half < 2; ++half)
+            {
+                std::uint64_t* q = state.data() + half * 8;
 
-        Block encryptedBlock;
+                std::array<std::uint64_t, 8> rotated;
+                std::array<std::uint64_t, 8> sums;
+                for (std::size_t bit = 0; bit < 8; ++bit)
+                {
+                    rotated[bit] = rotateRows1(q[bit]);
+                    sums[bit] = q[bit] ^ rotated[bit];
+                    q[bit] = sums[bit];
+                }
 
-        auto initVectorIterator = std::begin(initVector);
-        for (auto& w : encryptedBlock)
-            for (auto& b : w)
-                b = static_cast<std::uint8_t>(*initVectorIterator++);
+                mulBitsliced(q);
 
-        auto resultIterator = result.begin();
+                for (std::size_t bit = 0; bit < 8; ++bit)
+                    q[bit] ^= rotated[bit] ^ rotateRows2(sums[bit]);
+            }
+        }
 
-        for (const auto& block : blocks)
+        // the inverse matrix is the product of the forward one and 5 0 4 0
+        inline void invMixColumnsBitsliced(BitslicedState& state) noexcept
         {
-            encrypt<keyLength>(encryptedBlock, key);
-            encryptedBlock ^= block;
+            for (std::size_t half = 0; half < 2; ++half)
+            {
+                std::uint64_t* q = state.data() + half * 8;
 
-            // copy the block to output
-            for (const auto w : encryptedBlock)
-                for (const auto b : w)
-                    *resultIterator++ = b;
+                std::array<std::uint64_t, 8> sums;
+                for (std::size_t bit = 0; bit < 8; ++bit)
+                    sums[bit] = q[bit] ^ rotateRows2(q[bit]);
+
+                mulBitsliced(sums.data());
+                mulBitsliced(sums.data());
+
+                for (std::size_t bit = 0; bit < 8; ++bit)
+                    q[bit] ^= sums[bit];
+            }
+
+            mixColumnsBitsliced(state);
         }
 
-        return result;
-    }
+        inline void addRoundKeyBitsliced(BitslicedState& state, const BitslicedState& roundKey) noexcept
+        {
+            for (std::size_t i = 0; i < state.size(); ++i)
+                state[i] ^= roundKey[i];
+        }
 
-    template <std::size_t keyLength, class Data, class Key, class InitVector>
-    [[nodiscard]]
-    std::vector<std::uint8_t> encryptCfb(const Data& data, const Key& key,
-                                         const InitVector& initVector)
-    {
-        return encryptCfb<keyLength>(std::begin(data), std::end(data), key, initVector);
-    }
+        // spreads every bit of the round keys to all the blocks
+        template <std::size_t keyLength>
+        void bitsliceRoundKeys(const RoundKeys<keyLength>& roundKeys,
+                               BitslicedRoundKeys<keyLength>& bitslicedRoundKeys) noexcept
+        {
+            for (std::size_t round = 0; round <= roundCount<keyLength>; ++round)
+            {
+                std::array<Block, parallelBlockCount> blocks;
+                blocks.fill(roundKeys[round]);
+                bitslice(blocks.data(), bitslicedRoundKeys[round]);
+            }
+        }
 
-    template <std::size_t keyLength, class Iterator, class Key, class InitVector>
-    [[nodiscard]]
-    std::vector<std::uint8_t> decryptCfb(Iterator begin, Iterator end, const Key& key,
-                                         const InitVector& initVector)
-    {
-        const auto blocks = convertToBlocks(begin, end);
-        std::vector<std::uint8_t> result(blocks.size() * blockByteCount);
+        // S-box substitution of a column value without table lookups for the key schedule
+        [[nodiscard]] inline std::uint32_t subBitsliced(const std::uint32_t column) noexcept
+        {
+            std::array<std::uint64_t, 8> planes{};
+            for (std::size_t bit = 0; bit < 8; ++bit)
+                for (std::size_t i = 0; i < wordByteCount; ++i)
+                    planes[bit] |= static_cast<std::uint64_t>((column >> (i * 8 + bit)) & 1U) << i;
+
+            subBytesBitsliced(planes.data());
+
+            std::uint32_t result = 0;
+            for (std::size_t bit = 0; bit < 8; ++bit)
+                for (std::size_t i = 0; i < wordByteCount; ++i)
+                    result |= static_cast<std::uint32_t>((planes[bit] >> i) & 1U) << (i * 8 + bit);
+            return result;
+        }
 
-        Block decryptedBlock;
+        template <std::size_t keyLength>
+        void encryptBlocksBitsliced(Block* blocks, const BitslicedRoundKeys<keyLength>& roundKeys) noexcept
+        {
+            BitslicedState state;
+            bitslice(blocks, state);
+
+            addRoundKeyBitsliced(state, roundKeys[0]);
+
+            for (std::size_t round = 1; round < roundCount<keyLength>; ++round)
+            {
+                subBytesBitsliced(state.data());
+                subBytesBitsliced(state.data() + 8);
+                shiftRowsBitsliced<false>(state);
+                mixColumnsBitsliced(state);
+                addRoundKeyBitsliced(state, roundKeys[round]);
+            }
 
-        auto initVectorIterator = std::begin(initVector);
-        for (auto& w : decryptedBlock)
-            for (auto& b : w)
-                b = *initVectorIterator++;
+            subBytesBitsliced(state.data());
+            subBytesBitsliced(state.data() + 8);
+            shiftRowsBitsliced<false>(state);
+            addRoundKeyBitsliced(state, roundKeys[roundCount<keyLength>]);
 
-        auto resultIterator = result.begin();
+            unbitslice(state, blocks);
+        }
 
-        for (const auto& block : blocks)
+        template <std::size_t keyLength>
+        void decryptBlocksBitsliced(Block* blocks, const BitslicedRoundKeys<keyLength>& roundKeys) noexcept
         {
-            encrypt<keyLength>(decryptedBlock, key);
-            decryptedBlock ^= block;
+            BitslicedState state;
+            bitslice(blocks, state);
 
-            // copy the block to output
-            for (const auto w : decryptedBlock)
-                for (const auto b : w)
-                    *resultIterator++ = b;
+            addRoundKeyBitsliced(state, roundKeys[roundCount<keyLength>]);
 
-            decryptedBlock = block;
+            for (std::size_t round = roundCount<keyLength> - 1; round > 0; --round)
+            {
+                shiftRowsBitsliced<true>(state);
+                invSubBytesBitsliced(state.data());
+                invSubBytesBitsliced(state.data() + 8);
+                addRoundKeyBitsliced(state, roundKeys[round]);
+                invMixColumnsBitsliced(state);
+            }
+
+            shiftRowsBitsliced<true>(state);
+            invSubBytesBitsliced(state.data());
+            invSubBytesBitsliced(state.data() + 8);
+            addRoundKeyBitsliced(state, roundKeys[0]);
+
+            unbitslice(state, blocks);
         }
 
-        return result;
-    }
+        // runs the function on parallelBlockCount blocks at a time, the remaining ones padded with zero blocks
+        template <class Function>
+        void processBlocksBitsliced(Block* blocks, std::size_t count, const Function& function) noexcept
+        {
+            for (; count >= parallelBlockCount; count -= parallelBlockCount, blocks += parallelBlockCount)
+                function(blocks);
 
-    template <std::size_t keyLength, class Data, class Key, class InitVector>
+            if (count > 0)
+            {
+                std::array<Block, parallelBlockCount> lastBlocks{};
+                std::copy(blocks, blocks + count, lastBlocks.begin());
+                function(lastBlocks.data());
+                std::copy(lastBlocks.begin(), lastBlocks.begin() + static_cast<std::ptrdiff_t>(count), blocks);
+            }
+        }
+
+#ifdef AES_X86
+        struct CpuFeatures final
+        {
+            bool aes = false;
+            bool pclmul = false;
+            bool ssse3 = false;
+        };
+
+        [[nodiscard]] inline CpuFeatures detectCpuFeatures() noexcept
+        {
+            CpuFeatures result;
+#  if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            const auto ecx = static_cast<unsigned int>(info[2]);
+#  else
+            unsigned int eax = 0;
+            unsigned int ebx = 0;
+            unsigned int ecx = 0;
+            unsigned int edx = 0;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+                return result;
+#  endif
+            result.aes = (ecx & (1U << 25)) != 0;
+            result.pclmul = (ecx & (1U << 1)) != 0;
+            result.ssse3 = (ecx & (1U << 9)) != 0;
+            return result;
+        }
+
+        [[nodiscard]] inline const CpuFeatures& getCpuFeatures() noexcept
+        {
+            static const CpuFeatures cpuFeatures = detectCpuFeatures();
+            return cpuFeatures;
+        }
+
+        AES_TARGET("sse2")
+        inline __m128i load(const RoundKey& roundKey) noexcept
+        {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(roundKey.data()));
+        }
+
+        AES_TARGET("sse2")
+        inline void store(RoundKey& roundKey, const __m128i value) noexcept
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(roundKey.data()), value);
+        }
+
+        // xors the previous round key words into each other and the key generation assist result
+        AES_TARGET("sse2")
+        inline __m128i expandRoundKey(__m128i key, const __m128i assist) noexcept
+        {
+            key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+            key = _mm_xor_si128(key, _mm_slli_si128(key, 8));
+            return _mm_xor_si128(key, assist);
+        }
+
+        // AES-128 key schedule, every round key is derived from the previous one
+        template <std::uint8_t roundConstant>
+        AES_TARGET("aes,sse2")
+        __m128i expandKeyHardware128(const __m128i key) noexcept
+        {
+            return expandRoundKey(key, _mm_shuffle_epi32(_mm_aeskeygenassist_si128(key, roundConstant), 0xFF));
+        }
+
+        // AES-192 key schedule, produces 6 words (one and a half round keys) at a time
+        template <std::uint8_t roundConstant>
+        AES_TARGET("aes,sse2")
+        void expandKeyHardware192(__m128i& first, __m128i& second) noexcept
+        {
+            first = expandRoundKey(first, _mm_shuffle_epi32(_mm_aeskeygenassist_si128(second, roundConstant), 0x55));
+            second = _mm_xor_si128(second, _mm_slli_si128(second, 4));
+            second = _mm_xor_si128(second, _mm_shuffle_epi32(first, 0xFF));
+        }
+
+        // AES-256 key schedule, alternates between RotWord+SubWord+Rcon and SubWord only
+        template <std::uint8_t roundConstant>
+        AES_TARGET("aes,sse2")
+        void expandKeyHardware256(__m128i& first, __m128i& second) noexcept
+        {
+            first = expandRoundKey(first, _mm_shuffle_epi32(_mm_aeskeygenassist_si128(second, roundConstant), 0xFF));
+            second = expandRoundKey(second, _mm_shuffle_epi32(_mm_aeskeygenassist_si128(first, 0x00), 0xAA));
+        }
+
+        AES_TARGET("sse2")
+        inline __m128i combineLow(const __m128i first, const __m128i second) noexcept
+        {
+            return _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(first), _mm_castsi128_pd(second), 0));
+        }
+
+        AES_TARGET("sse2")
+        inline __m128i combineHigh(const __m128i first, const __m128i second) noexcept
+        {
+            return _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(first), _mm_castsi128_pd(second), 1));
+        }
+
+        // either of the schedules can be null when it is not needed
+        template <std::size_t keyLength, class Key>
+        AES_TARGET("aes,sse2")
+        void expandKeyHardware(const Key& key,
+                               RoundKeys<keyLength>* roundKeys,
+                               RoundKeys<keyLength>* decryptionRoundKeys) noexcept
+        {
+            std::array<std::uint8_t, 2 * blockByteCount> keyBytes{};
+            for (std::size_t i = 0; i < keyLength / 8; ++i)
+                keyBytes[i] = static_cast<std::uint8_t>(key[i]);
+
+            std::array<RoundKey, 2> keyBlocks;
+            std::memcpy(keyBlocks.data(), keyBytes.data(), keyBytes.size());
+
+            __m128i keys[roundCount<keyLength> + 1];
+            __m128i first = load(keyBlocks[0]);
+            __m128i second = load(keyBlocks[1]);
+
+            if constexpr (keyLength == 128)
+            {
+                keys[0] = first;
+                keys[1] = first = expandKeyHardware128<0x01>(first);
+                keys[2] = first = expandKeyHardware128<0x02>(first);
+                keys[3] = first = expandKeyHardware128<0x04>(first);
+                keys[4] = first = expandKeyHardware128<0x08>(first);
+                keys[5] = first = expandKeyHardware128<0x10>(first);
+                keys[6] = first = expandKeyHardware128<0x20>(first);
+                keys[7] = first = expandKeyHardware128<0x40>(first);
+                keys[8] = first = expandKeyHardware128<0x80>(first);
+                keys[9] = first = expandKeyHardware128<0x1B>(first);
+                keys[10] = expandKeyHardware128<0x36>(first);
+            }
+            else if constexpr (keyLength == 192)
+            {
+                keys[0] = first;
+                keys[1] = second;
+                expandKeyHardware192<0x01>(first, second);
+                keys[1] = combineLow(keys[1], first);
+                keys[2] = combineHigh(first, second);
+                expandKeyHardware192<0x02>(first, second);
+                keys[3] = first;
+                keys[4] = second;
+                expandKeyHardware192<0x04>(first, second);
+                keys[4] = combineLow(keys[4], first);
+                keys[5] = combineHigh(first, second);
+                expandKeyHardware192<0x08>(first, second);
+                keys[6] = first;
+                keys[7] = second;
+                expandKeyHardware192<0x10>(first, second);
+                keys[7] = combineLow(keys[7], first);
+                keys[8] = combineHigh(first, second);
+                expandKeyHardware192<0x20>(first, second);
+                keys[9] = first;
+                keys[10] = second;
+                expandKeyHardware192<0x40>(first, second);
+                keys[10] = combineLow(keys[10], first);
+                keys[11] = combineHigh(first, second);
+                expandKeyHardware192<0x80>(first, second);
+                keys[12] = first;
+            }
+            else if constexpr (keyLength == 256)
+            {
+                keys[0] = first;
+                keys[1] = second;
+                expandKeyHardware256<0x01>(first, second);
+                keys[2] = first;
+                keys[3] = second;
+                expandKeyHardware256<0x02>(first, second);
+                keys[4] = first;
+                keys[5] = second;
+                expandKeyHardware256<0x04>(first, second);
+                keys[6] = first;
+                keys[7] = second;
+                expandKeyHardware256<0x08>(first, second);
+                keys[8] = first;
+                keys[9] = second;
+                expandKeyHardware256<0x10>(first, second);
+                keys[10] = first;
+                keys[11] = second;
+                expandKeyHardware256<0x20>(first, second);
+                keys[12] = first;
+                keys[13] = second;
+                keys[14] = expandRoundKey(first, _mm_shuffle_epi32(_mm_aeskeygenassist_si128(second, 0x40), 0xFF));
+            }
+            else
+                static_assert(keyLength == 128 || keyLength == 192 || keyLength == 256, "Invalid key length");
+
+            // AESIMC turns the round keys into the equivalent inverse cipher round keys
+            if (decryptionRoundKeys != nullptr)
+            {
+                store((*decryptionRoundKeys)[0], keys[roundCount<keyLength>]);
+                for (std::size_t round = 1; round < roundCount<keyLength>; ++round)
+                    store((*decryptionRoundKeys)[round], _mm_aesimc_si128(keys[roundCount<keyLength> - round]));
+                store((*decryptionRoundKeys)[roundCount<keyLength>], keys[0]);
+            }
+
+            if (roundKeys != nullptr)
+                for (std::size_t round = 0; round <= roundCount<keyLength>; ++round)
+                    store((*roundKeys)[round], keys[round]);
+        }
+
+        template <std::size_t keyLength>
+        AES_TARGET("aes,sse2")
+        void encryptBlockHardware(Block& block, const RoundKeys<keyLength>& roundKeys) noexcept
+        {
+            __m128i state = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block.data()));
+            state = _mm_xor_si128(state, load(roundKeys[0]));
+            for (std::size_t round = 1; round < roundCount<keyLength>; ++round)
+                state = _mm_aesenc_si128(state, load(roundKeys[round]));
+            state = _mm_aesenclast_si128(state, load(roundKeys[roundCount<keyLength>]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(block.data()), state);
+        }
+
+        template <std::size_t keyLength>
+        AES_TARGET("aes,sse2")
+        void decryptBlockHardware(Block& block, const RoundKeys<keyLength>& decryptionRoundKeys) noexcept
+        {
+            __m128i state = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block.data()));
+            state = _mm_xor_si128(state, load(decryptionRoundKeys[0]));
+            for (std::size_t round = 1; round < roundCount<keyLength>; ++round)
+                state = _mm_aesdec_si128(state, load(decryptionRoundKeys[round]));
+            state = _mm_aesdeclast_si128(state, load(decryptionRoundKeys[roundCount<keyLength>]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(block.data()), state);
+        }
+
+        // the index sequence unrolls the interleaved blocks so that their states stay in registers
+        template <std::size_t keyLength, std::size_t... indices>
+        AES_TARGET("aes,sse2")
+        void encryptBlocksHardware(Block* blocks, const __m128i* keys, std::index_sequence<indices...>) noexcept
+        {
+            __m128i states[] = {
+                _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks[indices].data())), keys[0])...
+            };
+
+            for (std::size_t round = 1; round < roundCount<keyLength>; ++round)
+                ((states[indices] = _mm_aesenc_si128(states[indices], keys[round])), ...);
+
+            (_mm_storeu_si128(reinterpret_cast<__m128i*>(blocks[indices].data()),
+                              _mm_aesenclast_si128(states[indices], keys[roundCount<keyLength>])), ...);
+        }
+
+        template <std::size_t keyLength>
+        AES_TARGET("aes,sse2")
+        void encryptBlocksHardware(Block* blocks, std::size_t count, const RoundKeys<keyLength>& roundKeys) noexcept
+        {
+            __m128i keys[roundCount<keyLength> + 1];
+            for (std::size_t round = 0; round <= roundCount<keyLength>; ++round)
+                keys[round] = load(roundKeys[round]);
+
+            for (; count >= parallelBlockCount; count -= parallelBlockCount, blocks += parallelBlockCount)
+                encryptBlocksHardware<keyLength>(blocks, keys, std::make_index_sequence<parallelBlockCount>{});
+
+            for (; count > 0; --count, ++blocks)
+            {
+                __m128i state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks->data())), keys[0]);
+                for (std::size_t round = 1; round < roundCount<keyLength>; ++round)
+                    state = _mm_aesenc_si128(state, keys[round]);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(blocks->data()),
+                                 _mm_aesenclast_si128(state, keys[roundCount<keyLength>]));
+            }
+        }
+
+        template <std::size_t keyLength, std::size_t... indices>
+        AES_TARGET("aes,sse2")
+        void decryptBlocksHardware(Block* blocks, const __m128i* keys, std::index_sequence<indices...>) noexcept
+        {
+            __m128i states[] = {
+                _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks[indices].data())), keys[0])...
+            };
+
+            for (std::size_t round = 1; round < roundCount<keyLength>; ++round)
+                ((states[indices] = _mm_aesdec_si128(states[indices], keys[round])), ...);
+
+            (_mm_storeu_si128(reinterpret_cast<__m128i*>(blocks[indices].data()),
+                              _mm_aesdeclast_si128(states[indices], keys[roundCount<keyLength>])), ...);
+        }
+
+        template <std::size_t keyLength>
+        AES_TARGET("aes,sse2")
+        void decryptBlocksHardware(Block* blocks, std::size_t count, const RoundKeys<keyLength>& decryptionRoundKeys) noexcept
+        {
+            __m128i keys[roundCount<keyLength> + 1];
+            for (std::size_t round = 0; round <= roundCount<keyLength>; ++round)
+                keys[round] = load(decryptionRoundKeys[round]);
+
+            for (; count >= parallelBlockCount; count -= parallelBlockCount, blocks += parallelBlockCount)
+                decryptBlocksHardware<keyLength>(blocks, keys, std::make_index_sequence<parallelBlockCount>{});
+
+            for (; count > 0; --count, ++blocks)
+            {
+                __m128i state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks->data())), keys[0]);
+                for (std::size_t round = 1; round < roundCount<keyLength>; ++round)
+                    state = _mm_aesdec_si128(state, keys[round]);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(blocks->data()),
+                                 _mm_aesdeclast_si128(state, keys[roundCount<keyLength>]));
+            }
+        }
+
+        // encrypts blocks that each have their own key schedule, interleaving them
+        template <std::size_t keyLength, std::size_t... indices>
+        AES_TARGET("aes,sse2")
+        void encryptLanesHardware(Block* blocks, const RoundKeys<keyLength>* const* roundKeys,
+                                  std::index_sequence<indices...>) noexcept
+        {
+            __m128i states[] = {
+                _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks[indices].data())),
+                              load((*roundKeys[indices])[0]))...
+            };
+
+            for (std::size_t round = 1; round < roundCount<keyLength>; ++round)
+                ((states[indices] = _mm_aesenc_si128(states[indices], load((*roundKeys[indices])[round]))), ...);
+
+            (_mm_storeu_si128(reinterpret_cast<__m128i*>(blocks[indices].data()),
+                              _mm_aesenclast_si128(states[indices], load((*roundKeys[indices])[roundCount<keyLength>]))), ...);
+        }
+
+        template <std::size_t keyLength, std::size_t... indices>
+        AES_TARGET("aes,sse2")
+        void decryptLanesHardware(Block* blocks, const RoundKeys<keyLength>* const* decryptionRoundKeys,
+                                  std::index_sequence<indices...>) noexcept
+        {
+            __m128i states[] = {
+                _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks[indices].data())),
+                              load((*decryptionRoundKeys[indices])[0]))...
+            };
+
+            for (std::size_t round = 1; round < roundCount<keyLength>; ++round)
+                ((states[indices] = _mm_aesdec_si128(states[indices], load((*decryptionRoundKeys[indices])[round]))), ...);
+
+            (_mm_storeu_si128(reinterpret_cast<__m128i*>(blocks[indices].data()),
+                              _mm_aesdeclast_si128(states[indices], load((*decryptionRoundKeys[indices])[roundCount<keyLength>]))), ...);
+        }
+
+        // Runs the jobs on parallelBlockCount lanes, each with the key schedule of its job, taking the
+        // next job into a lane when its job is done. prepare(chainBlock, inputBlock) returns the block
+        // for the cipher and finish(chainBlock, inputBlock, block) returns the output block.
+        template <std::size_t keyLength, bool decryption, bool padded, class Prepare, class Finish>
+        void processJobsHardware(const Job* jobs, const std::size_t count,
+                                 const Prepare& prepare, const Finish& finish) noexcept
+        {
+            std::array<const Job*, parallelBlockCount> laneJobs{};
+            std::array<std::size_t, parallelBlockCount> offsets{};
+            std::array<Block, parallelBlockCount> chainBlocks{};
+            // only the schedule of the direction is expanded, the inverse one costs an AESIMC per round
+            std::array<RoundKeys<keyLength>, parallelBlockCount> roundKeys;
+            std::size_t nextJob = 0;
+
+            const auto startJob = [&](const std::size_t lane) noexcept {
+                laneJobs[lane] = nullptr;
+                while (nextJob < count && laneJobs[lane] == nullptr)
+                {
+                    const Job& job = jobs[nextJob++];
+                    if (job.size == 0) continue;
+
+                    laneJobs[lane] = &job;
+                    offsets[lane] = 0;
+                    chainBlocks[lane] = Block{};
+                    if (job.initVector != nullptr)
+                        std::memcpy(chainBlocks[lane].data(), job.initVector, blockByteCount);
+                    if constexpr (decryption)
+                        expandKeyHardware<keyLength>(job.key, nullptr, &roundKeys[lane]);
+                    else
+                        expandKeyHardware<keyLength>(job.key, &roundKeys[lane], nullptr);
+                }
+            };
+
+            for (std::size_t lane = 0; lane < parallelBlockCount; ++lane)
+                startJob(lane);
+
+            std::array<Block, parallelBlockCount> inputBlocks;
+            std::array<Block, parallelBlockCount> blocks;
+            std::array<const RoundKeys<keyLength>*, parallelBlockCount> keys;
+            std::array<std::size_t, parallelBlockCount> lanes;
+
+            for (;;)
+            {
+                std::size_t activeCount = 0;
+                for (std::size_t lane = 0; lane < parallelBlockCount; ++lane)
+                    if (laneJobs[lane] != nullptr)
+                    {
+                        const Job& job = *laneJobs[lane];
+                        const std::size_t remaining = job.size - offsets[lane];
+                        if (remaining >= blockByteCount)
+                            std::memcpy(inputBlocks[activeCount].data(), job.input + offsets[lane], blockByteCount);
+                        else
+                        {
+                            inputBlocks[activeCount] = Block{};
+                            std::memcpy(inputBlocks[activeCount].data(), job.input + offsets[lane], remaining);
+                        }
+                        blocks[activeCount] = prepare(chainBlocks[lane], inputBlocks[activeCount]);
+                        keys[activeCount] = &roundKeys[lane];
+                        lanes[activeCount++] = lane;
+                    }
+
+                if (activeCount == 0) break;
+
+                // the unused lanes of the last blocks repeat the first one
+                for (std::size_t i = activeCount; i < parallelBlockCount; ++i)
+                {
+                    blocks[i] = blocks[0];
+                    keys[i] = keys[0];
+                }
+
+                if constexpr (decryption)
+                    decryptLanesHardware<keyLength>(blocks.data(), keys.data(), std::make_index_sequence<parallelBlockCount>{});
+                else
+                    encryptLanesHardware<keyLength>(blocks.data(), keys.data(), std::make_index_sequence<parallelBlockCount>{});
+
+                for (std::size_t i = 0; i < activeCount; ++i)
+                {
+                    const std::size_t lane = lanes[i];
+                    const Job& job = *laneJobs[lane];
+                    const Block output = finish(chainBlocks[lane], inputBlocks[i], blocks[i]);
+                    const std::size_t remaining = job.size - offsets[lane];
+                    if (padded || remaining >= blockByteCount)
+                        std::memcpy(job.output + offsets[lane], output.data(), blockByteCount);
+                    else
+                        std::memcpy(job.output + offsets[lane], output.data(), remaining);
+
+                    offsets[lane] += blockByteCount;
+                    if (offsets[lane] >= job.size)
+                        startJob(lane);
+                }
+            }
+        }
+
+        AES_TARGET("ssse3")
+        inline __m128i reverseBytes(const __m128i value) noexcept
+        {
+            return _mm_shuffle_epi8(value, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        }
+
+        // accumulates the 256-bit carry-less product of the byte-reversed GF(2^128) elements
+        AES_TARGET("pclmul,sse2")
+        inline void multiplyAccumulate(const __m128i a, const __m128i b, __m128i& low, __m128i& high) noexcept
+        {
+            const __m128i middle = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+            low = _mm_xor_si128(low, _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x00), _mm_slli_si128(middle, 8)));
+            high = _mm_xor_si128(high, _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x11), _mm_srli_si128(middle, 8)));
+        }
+
+        // shifts the product left by one bit to account for the reflected bit order
+        // and reduces it modulo x^128 + x^7 + x^2 + x + 1
+        AES_TARGET("sse2")
+        inline __m128i reduce(__m128i low, __m128i high) noexcept
+        {
+            __m128i lowCarry = _mm_srli_epi32(low, 31);
+            __m128i highCarry = _mm_srli_epi32(high, 31);
+            low = _mm_slli_epi32(low, 1);
+            high = _mm_slli_epi32(high, 1);
+            const __m128i crossCarry = _mm_srli_si128(lowCarry, 12);
+            highCarry = _mm_slli_si128(highCarry, 4);
+            lowCarry = _mm_slli_si128(lowCarry, 4);
+            low = _mm_or_si128(low, lowCarry);
+            high = _mm_or_si128(_mm_or_si128(high, highCarry), crossCarry);
+
+            __m128i first = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(low, 31), _mm_slli_epi32(low, 30)), _mm_slli_epi32(low, 25));
+            const __m128i second = _mm_srli_si128(first, 4);
+            first = _mm_slli_si128(first, 12);
+            low = _mm_xor_si128(low, first);
+
+            const __m128i third = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(low, 1), _mm_srli_epi32(low, 2)),
+                                                _mm_xor_si128(_mm_srli_epi32(low, 7), second));
+            return _mm_xor_si128(high, _mm_xor_si128(low, third));
+        }
+
+        AES_TARGET("pclmul,sse2")
+        inline __m128i multiply(const __m128i a, const __m128i b) noexcept
+        {
+            __m128i low = _mm_setzero_si128();
+            __m128i high = _mm_setzero_si128();
+            multiplyAccumulate(a, b, low, high);
+            return reduce(low, high);
+        }
+
+        // stores H, H^2, H^3 and H^4 byte-reversed
+        AES_TARGET("pclmul,ssse3,sse2")
+        inline void initGhashHardware(const BlockBytes& hashKey, std::array<BlockBytes, 4>& powers) noexcept
+        {
+            const __m128i h = reverseBytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hashKey.data())));
+            __m128i power = h;
+            for (auto& p : powers)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(p.data()), power);
+                power = multiply(power, h);
+            }
+        }
+
+        // runs four blocks through a single reduction: X = (X + B1)H^4 + B2H^3 + B3H^2 + B4H
+        AES_TARGET("pclmul,ssse3,sse2")
+        inline void ghashHardware(BlockBytes& state, const std::array<BlockBytes, 4>& powers,
+                                  const std::uint8_t* data, std::size_t blockCount) noexcept
+        {
+            const __m128i h1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(powers[0].data()));
+            const __m128i h2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(powers[1].data()));
+            const __m128i h3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(powers[2].data()));
+            const __m128i h4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(powers[3].data()));
+            auto input = reinterpret_cast<const __m128i*>(data);
+
+            __m128i x = reverseBytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state.data())));
+
+            for (; blockCount >= 4; blockCount -= 4, input += 4)
+            {
+                __m128i low = _mm_setzero_si128();
+                __m128i high = _mm_setzero_si128();
+                multiplyAccumulate(_mm_xor_si128(x, reverseBytes(_mm_loadu_si128(input))), h4, low, high);
+                multiplyAccumulate(reverseBytes(_mm_loadu_si128(input + 1)), h3, low, high);
+                multiplyAccumulate(reverseBytes(_mm_loadu_si128(input + 2)), h2, low, high);
+                multiplyAccumulate(reverseBytes(_mm_loadu_si128(input + 3)), h1, low, high);
+                x = reduce(low, high);
+            }
+
+            for (; blockCount > 0; --blockCount, ++input)
+                x = multiply(_mm_xor_si128(x, reverseBytes(_mm_loadu_si128(input))), h1);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(state.data()), reverseBytes(x));
+        }
+#endif
+
+        template <std::size_t keyLength, class Key>
+        [[nodiscard]] constexpr RoundKeys<keyLength> expandDecryptionKey(const Key& key) noexcept
+        {
+            RoundKeys<keyLength> roundKeys{};
+            expandKey<keyLength>(key, roundKeys);
+            RoundKeys<keyLength> decryptionRoundKeys{};
+            invertRoundKeys<keyLength>(roundKeys, decryptionRoundKeys);
+            return decryptionRoundKeys;
+        }
+
+        template <std::size_t keyLength, class Key>
+        constexpr void encrypt(Block& block, const Key& key) noexcept
+        {
+            RoundKeys<keyLength> roundKeys{};
+            expandKey<keyLength>(key, roundKeys);
+            encryptBlockTable<keyLength>(block, roundKeys);
+        }
+
+        template <std::size_t keyLength, class Key>
+        constexpr void decrypt(Block& block, const Key& key) noexcept
+        {
+            decryptBlockTable<keyLength>(block, expandDecryptionKey<keyLength>(key));
+        }
+
+        // loads the block at the offset of the data without memcpy, so that it works in constant
+        // expressions, the bytes past the size are zero
+        template <class Data>
+        [[nodiscard]] constexpr Block loadBlock(const Data& data, const std::size_t size,
+                                                const std::size_t offset) noexcept
+        {
+            Block result{};
+            for (std::size_t j = 0; j < blockWordCount; ++j)
+            {
+                std::uint32_t column = 0;
+                for (std::size_t i = 0; i < wordByteCount; ++i)
+                    if (const std::size_t index = offset + j * wordByteCount + i; index < size)
+                        column |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[index])) << (i * 8);
+                storeColumn(result[j], column);
+            }
+            return result;
+        }
+
+        template <std::size_t size>
+        constexpr void storeBlock(std::array<std::uint8_t, size>& data, const std::size_t offset,
+                                  const Block& block) noexcept
+        {
+            for (std::size_t j = 0; j < blockWordCount; ++j)
+            {
+                const std::uint32_t column = loadColumn(block[j]);
+                for (std::size_t i = 0; i < wordByteCount; ++i)
+                    data[offset + j * wordByteCount + i] = static_cast<std::uint8_t>(column >> (i * 8));
+            }
+        }
+
+        // copies the input into a byte vector with spare capacity for the padding or tag of one block
+        template <class Iterator>
+        [[nodiscard]]
+        std::vector<std::uint8_t> convertToBytes(Iterator begin, Iterator end)
+        {
+            std::vector<std::uint8_t> result;
+
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                            typename std::iterator_traits<Iterator>::iterator_category>)
+            {
+                const auto size = static_cast<std::size_t>(std::distance(begin, end));
+                result.reserve(size + blockByteCount);
+                result.resize(size);
+                std::transform(begin, end, result.begin(), [](const auto b) noexcept {
+                    return static_cast<std::uint8_t>(b);
+                });
+            }
+            else
+                for (auto i = begin; i != end; ++i)
+                    result.push_back(static_cast<std::uint8_t>(*i));
+
+            return result;
+        }
+
+        // adds the value to the block treated as a 128-bit big-endian counter
+        inline void addCounter(Block& counter, std::uint64_t value) noexcept
+        {
+            for (std::size_t j = blockWordCount; j-- > 0 && value != 0;)
+            {
+                const std::uint64_t sum = static_cast<std::uint64_t>(swapBytes(loadColumn(counter[j]))) + (value & 0xFFFFFFFFU);
+                storeColumn(counter[j], swapBytes(static_cast<std::uint32_t>(sum)));
+                value = (value >> 32) + (sum >> 32);
+            }
+        }
+
+        // increments the last counterByteCount bytes of the block as a big-endian counter,
+        // the bytes of its columns are swapped to add with carry
+        template <std::size_t counterByteCount = blockByteCount>
+        void incrementCounter(Block& counter) noexcept
+        {
+            static_assert(counterByteCount % wordByteCount == 0);
+
+            for (std::size_t j = blockWordCount; j-- > blockWordCount - counterByteCount / wordByteCount;)
+            {
+                const std::uint32_t value = swapBytes(loadColumn(counter[j])) + 1;
+                storeColumn(counter[j], swapBytes(value));
+                if (value != 0) break;
+            }
+        }
+
+        // GCM increments only the last 32 bits of the counter block
+        constexpr std::size_t gcmCounterByteCount = 4;
+        constexpr std::size_t gcmInitVectorByteCount = 12;
+        // SP 800-38D limits the plaintext to 2^39 - 256 bits, so that the 32-bit counter does not wrap
+        constexpr std::uint64_t gcmMaxDataByteCount = (std::uint64_t{1} << 36) - 32;
+        constexpr std::size_t tagByteCount = 16;
+
+        // the bytes of the block in memory order
+        [[nodiscard]] inline std::uint8_t* getBytes(Block& block) noexcept
+        {
+            return reinterpret_cast<std::uint8_t*>(block.data());
+        }
+
+        [[nodiscard]] inline const std::uint8_t* getBytes(const Block& block) noexcept
+        {
+            return reinterpret_cast<const std::uint8_t*>(block.data());
+        }
+
+        [[nodiscard]] inline BlockBytes toBytes(const Block& block) noexcept
+        {
+            BlockBytes result;
+            std::memcpy(result.data(), block.data(), blockByteCount);
+            return result;
+        }
+
+        [[nodiscard]] inline Block toBlock(const BlockBytes& bytes) noexcept
+        {
+            Block result;
+            std::memcpy(result.data(), bytes.data(), blockByteCount);
+            return result;
+        }
+
+        // multiplies the XTS tweak by x in GF(2^128), the bytes are in little-endian order
+        inline void multiplyTweak(Block& tweak) noexcept
+        {
+            const std::uint64_t low = loadColumn(tweak[0]) | (static_cast<std::uint64_t>(loadColumn(tweak[1])) << 32);
+            const std::uint64_t high = loadColumn(tweak[2]) | (static_cast<std::uint64_t>(loadColumn(tweak[3])) << 32);
+            const std::uint64_t newLow = (low << 1) ^ ((std::uint64_t{0} - (high >> 63)) & 0x87U);
+            const std::uint64_t newHigh = (high << 1) | (low >> 63);
+            storeColumn(tweak[0], static_cast<std::uint32_t>(newLow));
+            storeColumn(tweak[1], static_cast<std::uint32_t>(newLow >> 32));
+            storeColumn(tweak[2], static_cast<std::uint32_t>(newHigh));
+            storeColumn(tweak[3], static_cast<std::uint32_t>(newHigh >> 32));
+        }
+
+        // doubles the CMAC subkey in GF(2^128), the bytes are in big-endian order
+        inline void doubleSubkey(Block& subkey) noexcept
+        {
+            const std::uint64_t high = (static_cast<std::uint64_t>(swapBytes(loadColumn(subkey[0]))) << 32) | swapBytes(loadColumn(subkey[1]));
+            const std::uint64_t low = (static_cast<std::uint64_t>(swapBytes(loadColumn(subkey[2]))) << 32) | swapBytes(loadColumn(subkey[3]));
+            const std::uint64_t newHigh = (high << 1) | (low >> 63);
+            const std::uint64_t newLow = (low << 1) ^ ((std::uint64_t{0} - (high >> 63)) & 0x87U);
+            storeColumn(subkey[0], swapBytes(static_cast<std::uint32_t>(newHigh >> 32)));
+            storeColumn(subkey[1], swapBytes(static_cast<std::uint32_t>(newHigh)));
+            storeColumn(subkey[2], swapBytes(static_cast<std::uint32_t>(newLow >> 32)));
+            storeColumn(subkey[3], swapBytes(static_cast<std::uint32_t>(newLow)));
+        }
+
+        // compares all the bytes to not leak the position of the first mismatch
+        [[nodiscard]] inline bool isTagEqual(const std::uint8_t* first, const std::uint8_t* second) noexcept
+        {
+            std::uint8_t difference = 0;
+            for (std::size_t i = 0; i < tagByteCount; ++i)
+                difference |= static_cast<std::uint8_t>(first[i] ^ second[i]);
+            return difference == 0;
+        }
+
+        // GHASH universal hash of GCM, multiplies in GF(2^128) either with PCLMULQDQ
+        // or with 4-bit multiplication tables of the hash key (Shoup's method)
+        class Ghash final
+        {
+        public:
+            Ghash(const BlockBytes& hashKey, [[maybe_unused]] const bool useHardware) noexcept
+            {
+#ifdef AES_X86
+                hardware = useHardware && getCpuFeatures().pclmul && getCpuFeatures().ssse3;
+                if (hardware)
+                {
+                    initGhashHardware(hashKey, powers);
+                    return;
+                }
+#endif
+                std::uint64_t high = 0;
+                std::uint64_t low = 0;
+                for (std::size_t i = 0; i < 8; ++i)
+                {
+                    high = (high << 8) | hashKey[i];
+                    low = (low << 8) | hashKey[i + 8];
+                }
+
+                // H times x^0, x^1, x^2 and x^3 (in the reflected bit order) go to indices 8, 4, 2 and 1
+                tableHigh[8] = high;
+                tableLow[8] = low;
+                for (std::size_t i = 4; i > 0; i >>= 1)
+                {
+                    const std::uint64_t reduction = (low & 1U) ? 0xE100000000000000U : 0U;
+                    low = (high << 63) | (low >> 1);
+                    high = (high >> 1) ^ reduction;
+                    tableHigh[i] = high;
+                    tableLow[i] = low;
+                }
+
+                // the rest of the entries are sums of those
+                for (std::size_t i = 2; i <= 8; i <<= 1)
+                    for (std::size_t j = 1; j < i; ++j)
+                    {
+                        tableHigh[i + j] = tableHigh[i] ^ tableHigh[j];
+                        tableLow[i + j] = tableLow[i] ^ tableLow[j];
+                    }
+            }
+
+            // absorbs the bytes zero-padded to a whole number of blocks
+            void update(const std::uint8_t* data, const std::size_t size) noexcept
+            {
+                const std::size_t blockCount = size / blockByteCount;
+                process(data, blockCount);
+
+                if (const std::size_t remainder = size % blockByteCount; remainder != 0)
+                {
+                    BlockBytes lastBlock{};
+                    std::copy(data + blockCount * blockByteCount, data + size, lastBlock.begin());
+                    process(lastBlock.data(), 1);
+                }
+            }
+
+            template <class Iterator>
+            void update(Iterator begin, Iterator end) noexcept
+            {
+                std::array<std::uint8_t, 4 * blockByteCount> buffer{};
+                std::size_t size = 0;
+                for (auto i = begin; i != end; ++i)
+                {
+                    buffer[size++] = static_cast<std::uint8_t>(*i);
+                    if (size == buffer.size())
+                    {
+                        process(buffer.data(), buffer.size() / blockByteCount);
+                        size = 0;
+                    }
+                }
+
+                update(buffer.data(), size);
+            }
+
+            // absorbs the bit lengths of both inputs and returns the hash, leaving the state cleared
+            [[nodiscard]] BlockBytes finalize(const std::uint64_t additionalDataSize,
+                                              const std::uint64_t dataSize) noexcept
+            {
+                BlockBytes lengths;
+                for (std::size_t i = 0; i < 8; ++i)
+                {
+                    lengths[i] = static_cast<std::uint8_t>((additionalDataSize * 8) >> (56 - i * 8));
+                    lengths[i + 8] = static_cast<std::uint8_t>((dataSize * 8) >> (56 - i * 8));
+                }
+                process(lengths.data(), 1);
+
+                const BlockBytes result = state;
+                state = BlockBytes{};
+                return result;
+            }
+
+        private:
+            void process(const std::uint8_t* data, std::size_t blockCount) noexcept
+            {
+#ifdef AES_X86
+                if (hardware)
+                {
+                    ghashHardware(state, powers, data, blockCount);
+                    return;
+                }
+#endif
+                for (; blockCount > 0; --blockCount, data += blockByteCount)
+                {
+                    for (std::size_t i = 0; i < blockByteCount; ++i)
+                        state[i] ^= data[i];
+                    multiply();
+                }
+            }
+
+            // state = state * H, four bits at a time starting from the last byte
+            void multiply() noexcept
+            {
+                // reductions of the four bits shifted out of the low end
+                constexpr std::array<std::uint64_t, 16> remainders{
+                    0x0000U, 0x1C20U, 0x3840U, 0x2460U, 0x7080U, 0x6CA0U, 0x48C0U, 0x54E0U,
+                    0xE100U, 0xFD20U, 0xD940U, 0xC560U, 0x9180U, 0x8DA0U, 0xA9C0U, 0xB5E0U
+                };
+
+                std::uint64_t high = 0;
+                std::uint64_t low = 0;
+
+                for (std::size_t i = blockByteCount; i-- > 0;)
+                    for (const std::size_t nibble : {state[i] & 0x0FU, static_cast<unsigned int>(state[i] >> 4U)})
+                    {
+                        const std::size_t remainder = low & 0x0FU;
+                        low = (high << 60) | (low >> 4);
+                        high = (high >> 4) ^ (remainders[remainder] << 48);
+                        high ^= tableHigh[nibble];
+                        low ^= tableLow[nibble];
+                    }
+
+                for (std::size_t i = 0; i < 8; ++i)
+                {
+                    state[i] = static_cast<std::uint8_t>(high >> (56 - i * 8));
+                    state[i + 8] = static_cast<std::uint8_t>(low >> (56 - i * 8));
+                }
+            }
+
+            BlockBytes state{};
+            std::array<std::uint64_t, 16> tableHigh{};
+            std::array<std::uint64_t, 16> tableLow{};
+#ifdef AES_X86
+            bool hardware = false;
+            std::array<BlockBytes, 4> powers{};
+#endif
+        };
+
+        // blocks a worker thread has to get at least to be worth starting
+        constexpr std::size_t minimumThreadBlockCount = 4096;
+
+        // size of the ranges parallelFor splits [0, count) into, count if it runs on a single thread
+        [[nodiscard]] inline std::size_t getChunkSize(const std::size_t count, std::size_t threadCount,
+                                                      const std::size_t itemBlockCount = 1) noexcept
+        {
+            threadCount = std::min(threadCount, count * itemBlockCount / minimumThreadBlockCount);
+            return (threadCount <= 1) ? count : (count + threadCount - 1) / threadCount;
+        }
+
+        // calls function(first, last) for consecutive ranges of [0, count) on up to threadCount threads,
+        // itemBlockCount is the number of blocks each of the items covers
+        template <class Function>
+        void parallelFor(const std::size_t count, const std::size_t threadCount, const Function& function,
+                         const std::size_t itemBlockCount = 1)
+        {
+            const std::size_t chunkSize = getChunkSize(count, threadCount, itemBlockCount);
+            if (chunkSize == count)
+            {
+                function(std::size_t{0}, count);
+                return;
+            }
+
+            std::vector<std::thread> threads;
+            threads.reserve(count / chunkSize);
+
+            try
+            {
+                for (std::size_t first = chunkSize; first < count; first += chunkSize)
+                    threads.emplace_back(function, first, std::min(first + chunkSize, count));
+            }
+            catch (...)
+            {
+                for (auto& thread : threads) thread.join();
+                throw;
+            }
+
+            function(std::size_t{0}, chunkSize);
+
+            for (auto& thread : threads) thread.join();
+        }
+
+        template <class InitVector>
+        [[nodiscard]]
+        Block convertToBlock(const InitVector& initVector) noexcept
+        {
+            BlockBytes result;
+
+            auto initVectorIterator = std::begin(initVector);
+            for (auto& b : result)
+                b = static_cast<std::uint8_t>(*initVectorIterator++);
+
+            return toBlock(result);
+        }
+    }
+
+    enum class Backend
+    {
+        reference, // rounds as specified in FIPS-197 on the columns of the state
+        table, // 32-bit lookup tables combining the round steps, equivalent inverse cipher for decryption
+        hardware, // AES-NI instructions
+        bitsliced // constant-time rounds on eight blocks at once without table lookups, a single
+                  // block costs a whole batch, so the serial paths (CBC and CFB encryption, CMAC,
+                  // GCM's H and J0, XTS stealing) run at about an eighth of the batched throughput
+    };
+
+    class BackendError final: public std::runtime_error
+    {
+    public:
+        using runtime_error::runtime_error;
+    };
+
+    class AuthenticationError final: public std::runtime_error
+    {
+    public:
+        using runtime_error::runtime_error;
+    };
+
+    class DataSizeError final: public std::logic_error
+    {
+    public:
+        using logic_error::logic_error;
+    };
+
+    [[nodiscard]] inline bool isSupported(const Backend backend) noexcept
+    {
+        switch (backend)
+        {
+            case Backend::reference:
+            case Backend::table:
+            case Backend::bitsliced:
+                return true;
+#ifdef AES_X86
+            case Backend::hardware:
+                return getCpuFeatures().aes;
+#endif
+            default:
+                return false;
+        }
+    }
+
+    // the fastest backend available on the CPU
+    [[nodiscard]] inline Backend getDefaultBackend() noexcept
+    {
+        return isSupported(Backend::hardware) ? Backend::hardware : Backend::table;
+    }
+
+    // output size of the block modes, the input rounded up to whole blocks
+    [[nodiscard]] constexpr std::size_t getPaddedSize(const std::size_t size) noexcept
+    {
+        return (size + blockByteCount - 1) / blockByteCount * blockByteCount;
+    }
+
+    // AES cipher with the key schedule expanded once at construction
+    template <std::size_t keyLength>
+    class Cipher final
+    {
+    public:
+        template <class Key>
+        explicit Cipher(const Key& key, const Backend initBackend = getDefaultBackend()):
+            backend{initBackend}
+        {
+            if (!isSupported(backend))
+                throw BackendError{"Backend not supported"};
+
+#ifdef AES_X86
+            if (backend == Backend::hardware)
+            {
+                expandKeyHardware<keyLength>(key, &roundKeys, &decryptionRoundKeys);
+                return;
+            }
+#endif
+
+            if (backend == Backend::bitsliced)
+            {
+                RoundKeys<keyLength> expandedRoundKeys;
+                expandKey<keyLength>(key, expandedRoundKeys, subBitsliced);
+                auto bitsliced = std::make_shared<BitslicedRoundKeys<keyLength>>();
+                bitsliceRoundKeys<keyLength>(expandedRoundKeys, *bitsliced);
+                bitslicedRoundKeys = std::move(bitsliced);
+                return;
+            }
+
+            expandKey<keyLength>(key, roundKeys);
+            invertRoundKeys<keyLength>(roundKeys, decryptionRoundKeys);
+        }
+
+        [[nodiscard]] Backend getBackend() const noexcept { return backend; }
+
+        // number of threads the parallelizable modes may split large inputs across
+        [[nodiscard]] std::size_t getThreadCount() const noexcept { return threadCount; }
+        void setThreadCount(const std::size_t newThreadCount) noexcept { threadCount = newThreadCount; }
+
+        void encrypt(Block& block) const noexcept
+        {
+            switch (backend)
+            {
+#ifdef AES_X86
+                case Backend::hardware:
+                    encryptBlockHardware<keyLength>(block, roundKeys);
+                    break;
+#endif
+                case Backend::table:
+                    encryptBlockTable<keyLength>(block, roundKeys);
+                    break;
+                case Backend::bitsliced:
+                    encryptBlocks(&block, 1);
+                    break;
+                default:
+                    encryptBlock<keyLength>(block, roundKeys);
+                    break;
+            }
+        }
+
+        void decrypt(Block& block) const noexcept
+        {
+            switch (backend)
+            {
+#ifdef AES_X86
+                case Backend::hardware:
+                    decryptBlockHardware<keyLength>(block, decryptionRoundKeys);
+                    break;
+#endif
+                case Backend::table:
+                    decryptBlockTable<keyLength>(block, decryptionRoundKeys);
+                    break;
+                case Backend::bitsliced:
+                    decryptBlocks(&block, 1);
+                    break;
+                default:
+                    decryptBlock<keyLength>(block, roundKeys);
+                    break;
+            }
+        }
+
+        // encrypts independent blocks, interleaving them on the hardware backend
+        void encryptBlocks(Block* blocks, const std::size_t count) const noexcept
+        {
+#ifdef AES_X86
+            if (backend == Backend::hardware)
+            {
+                encryptBlocksHardware<keyLength>(blocks, count, roundKeys);
+                return;
+            }
+#endif
+            if (backend == Backend::bitsliced)
+            {
+                processBlocksBitsliced(blocks, count, [this](Block* bitslicedBlocks) noexcept {
+                    encryptBlocksBitsliced<keyLength>(bitslicedBlocks, *bitslicedRoundKeys);
+                });
+                return;
+            }
+
+            for (std::size_t i = 0; i < count; ++i)
+                encrypt(blocks[i]);
+        }
+
+        // decrypts independent blocks, interleaving them on the hardware backend
+        void decryptBlocks(Block* blocks, const std::size_t count) const noexcept
+        {
+#ifdef AES_X86
+            if (backend == Backend::hardware)
+            {
+                decryptBlocksHardware<keyLength>(blocks, count, decryptionRoundKeys);
+                return;
+            }
+#endif
+            if (backend == Backend::bitsliced)
+            {
+                processBlocksBitsliced(blocks, count, [this](Block* bitslicedBlocks) noexcept {
+                    decryptBlocksBitsliced<keyLength>(bitslicedBlocks, *bitslicedRoundKeys);
+                });
+                return;
+            }
+
+            for (std::size_t i = 0; i < count; ++i)
+                decrypt(blocks[i]);
+        }
+
+        // The pointer overloads of the modes read size bytes from input and write to output without
+        // allocating, output may be the same buffer as input. The block modes zero-pad the last block,
+        // so their output must have room for getPaddedSize(size) bytes.
+
+        void encryptEcb(const std::uint8_t* input, const std::size_t size, std::uint8_t* output) const noexcept
+        {
+            processBlocks(input, size, output, [this](Block* blocks, const std::size_t count) noexcept {
+                encryptBlocks(blocks, count);
+            });
+        }
+
+        template <class Iterator>
+        [[nodiscard]]
+        std::vector<std::uint8_t> encryptEcb(Iterator begin, Iterator end) const
+        {
+            auto result = convertToBytes(begin, end);
+            const std::size_t size = result.size();
+            result.resize(getPaddedSize(size));
+            encryptEcb(result.data(), size, result.data());
+            return result;
+        }
+
+        template <class Data>
+        [[nodiscard]]
+        std::vector<std::uint8_t> encryptEcb(const Data& data) const
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            return encryptEcb(begin(data), end(data));
+        }
+
+        void decryptEcb(const std::uint8_t* input, const std::size_t size, std::uint8_t* output) const noexcept
+        {
+            processBlocks(input, size, output, [this](Block* blocks, const std::size_t count) noexcept {
+                decryptBlocks(blocks, count);
+            });
+        }
+
+        template <class Iterator>
+        [[nodiscard]]
+        std::vector<std::uint8_t> decryptEcb(Iterator begin, Iterator end) const
+        {
+            auto result = convertToBytes(begin, end);
+            const std::size_t size = result.size();
+            result.resize(getPaddedSize(size));
+            decryptEcb(result.data(), size, result.data());
+            return result;
+        }
+
+        template <class Data>
+        [[nodiscard]]
+        std::vector<std::uint8_t> decryptEcb(const Data& data) const
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            return decryptEcb(begin(data), end(data));
+        }
+
+        template <class InitVector>
+        void encryptCbc(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                        const InitVector& initVector) const noexcept
+        {
+            Block dataBlock = convertToBlock(initVector);
+
+            processBlocks(input, size, output, [this, &dataBlock](Block* blocks, const std::size_t count) noexcept {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    dataBlock ^= blocks[i];
+                    encrypt(dataBlock);
+                    blocks[i] = dataBlock;
+                }
+            });
+        }
+
+        template <class Iterator, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> encryptCbc(Iterator begin, Iterator end,
+                                             const InitVector& initVector) const
+        {
+            auto result = convertToBytes(begin, end);
+            const std::size_t size = result.size();
+            result.resize(getPaddedSize(size));
+            encryptCbc(result.data(), size, result.data(), initVector);
+            return result;
+        }
+
+        template <class Data, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> encryptCbc(const Data& data,
+                                             const InitVector& initVector) const
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            return encryptCbc(begin(data), end(data), initVector);
+        }
+
+        // the blocks only depend on the previous ciphertext block, so they are decrypted in batches
+        // and large inputs are split across threads
+        template <class InitVector>
+        void decryptCbc(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                        const InitVector& initVector) const
+        {
+            processChained(input, size, output, convertToBlock(initVector),
+                           [this](Block* blocks, const std::size_t count, Block& dataBlock) noexcept {
+                               std::array<Block, parallelBlockCount> encryptedBlocks;
+                               std::copy(blocks, blocks + count, encryptedBlocks.begin());
+
+                               decryptBlocks(blocks, count);
+
+                               blocks[0] ^= dataBlock;
+                               for (std::size_t i = 1; i < count; ++i)
+                                   blocks[i] ^= encryptedBlocks[i - 1];
+
+                               dataBlock = encryptedBlocks[count - 1];
+                           });
+        }
+
+        template <class Iterator, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> decryptCbc(Iterator begin, Iterator end,
+                                             const InitVector& initVector) const
+        {
+            auto result = convertToBytes(begin, end);
+            const std::size_t size = result.size();
+            result.resize(getPaddedSize(size));
+            decryptCbc(result.data(), size, result.data(), initVector);
+            return result;
+        }
+
+        template <class Data, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> decryptCbc(const Data& data,
+                                             const InitVector& initVector) const
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            return decryptCbc(begin(data), end(data), initVector);
+        }
+
+        template <class InitVector>
+        void encryptCfb(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                        const InitVector& initVector) const noexcept
+        {
+            Block encryptedBlock = convertToBlock(initVector);
+
+            processBlocks(input, size, output, [this, &encryptedBlock](Block* blocks, const std::size_t count) noexcept {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    encrypt(encryptedBlock);
+                    encryptedBlock ^= blocks[i];
+                    blocks[i] = encryptedBlock;
+                }
+            });
+        }
+
+        template <class Iterator, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> encryptCfb(Iterator begin, Iterator end,
+                                             const InitVector& initVector) const
+        {
+            auto result = convertToBytes(begin, end);
+            const std::size_t size = result.size();
+            result.resize(getPaddedSize(size));
+            encryptCfb(result.data(), size, result.data(), initVector);
+            return result;
+        }
+
+        template <class Data, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> encryptCfb(const Data& data,
+                                             const InitVector& initVector) const
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            return encryptCfb(begin(data), end(data), initVector);
+        }
+
+        // the key stream comes from the ciphertext, so it is generated in batches like in CTR mode
+        template <class InitVector>
+        void decryptCfb(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                        const InitVector& initVector) const
+        {
+            processChained(input, size, output, convertToBlock(initVector),
+                           [this](Block* blocks, const std::size_t count, Block& decryptedBlock) noexcept {
+                               std::array<Block, parallelBlockCount> keyStream;
+                               keyStream[0] = decryptedBlock;
+                               std::copy(blocks, blocks + count - 1, keyStream.begin() + 1);
+                               decryptedBlock = blocks[count - 1];
+
+                               encryptBlocks(keyStream.data(), count);
+
+                               for (std::size_t i = 0; i < count; ++i)
+                                   blocks[i] ^= keyStream[i];
+                           });
+        }
+
+        template <class Iterator, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> decryptCfb(Iterator begin, Iterator end,
+                                             const InitVector& initVector) const
+        {
+            auto result = convertToBytes(begin, end);
+            const std::size_t size = result.size();
+            result.resize(getPaddedSize(size));
+            decryptCfb(result.data(), size, result.data(), initVector);
+            return result;
+        }
+
+        template <class Data, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> decryptCfb(const Data& data,
+                                             const InitVector& initVector) const
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            return decryptCfb(begin(data), end(data), initVector);
+        }
+
+        // CTR mode turns the cipher into a stream cipher, encryption and decryption are the same operation
+        // and the output has the same size as the input
+        template <class InitVector>
+        void encryptCtr(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                        const InitVector& initVector) const
+        {
+            const Block counter = convertToBlock(initVector);
+
+            parallelFor((size + blockByteCount - 1) / blockByteCount, threadCount,
+                        [this, counter, input, size, output](const std::size_t first, const std::size_t last) noexcept {
+                            Block blockCounter = counter;
+                            addCounter(blockCounter, first);
+                            const std::size_t offset = first * blockByteCount;
+                            applyCounter(blockCounter, input + offset, output + offset,
+                                         std::min(last * blockByteCount, size) - offset);
+                        });
+        }
+
+        template <class Iterator, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> encryptCtr(Iterator begin, Iterator end,
+                                             const InitVector& initVector) const
+        {
+            auto result = convertToBytes(begin, end);
+            encryptCtr(result.data(), result.size(), result.data(), initVector);
+            return result;
+        }
+
+        template <class Data, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> encryptCtr(const Data& data, const InitVector& initVector) const
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            return encryptCtr(begin(data), end(data), initVector);
+        }
+
+        template <class InitVector>
+        void decryptCtr(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                        const InitVector& initVector) const
+        {
+            encryptCtr(input, size, output, initVector);
+        }
+
+        template <class Iterator, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> decryptCtr(Iterator begin, Iterator end,
+                                             const InitVector& initVector) const
+        {
+            return encryptCtr(begin, end, initVector);
+        }
+
+        template <class Data, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> decryptCtr(const Data& data, const InitVector& initVector) const
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            return decryptCtr(begin(data), end(data), initVector);
+        }
+
+        // writes the size bytes of ciphertext followed by the 16-byte tag to the output
+        template <class InitVector, class AdditionalData>
+        void encryptGcm(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                        const InitVector& initVector, const AdditionalData& additionalData) const
+        {
+            if (static_cast<std::uint64_t>(size) > gcmMaxDataByteCount)
+                throw DataSizeError{"Data too long"};
+
+            Ghash ghash{getHashKey(), backend == Backend::hardware};
+            const Block initialCounter = getInitialCounter(ghash, initVector);
+
+            Block counter = initialCounter;
+            incrementCounter<gcmCounterByteCount>(counter);
+            applyCounter<gcmCounterByteCount>(counter, input, output, size);
+
+            const auto tag = getTag(ghash, initialCounter, additionalData, output, size);
+            std::copy(tag.begin(), tag.end(), output + size);
+        }
+
+        // GCM authenticated encryption, returns the ciphertext followed by the 16-byte tag
+        template <class Iterator, class InitVector, class AdditionalData>
+        [[nodiscard]]
+        std::vector<std::uint8_t> encryptGcm(Iterator begin, Iterator end,
+                                             const InitVector& initVector,
+                                             const AdditionalData& additionalData) const
+        {
+            auto result = convertToBytes(begin, end);
+            const std::size_t size = result.size();
+            result.resize(size + tagByteCount);
+            encryptGcm(result.data(), size, result.data(), initVector, additionalData);
+            return result;
+        }
+
+        template <class Data, class InitVector, class AdditionalData>
+        [[nodiscard]]
+        std::vector<std::uint8_t> encryptGcm(const Data& data,
+                                             const InitVector& initVector,
+                                             const AdditionalData& additionalData) const
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            return encryptGcm(begin(data), end(data), initVector, additionalData);
+        }
+
+        template <class Data, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> encryptGcm(const Data& data, const InitVector& initVector) const
+        {
+            return encryptGcm(data, initVector, std::array<std::uint8_t, 0>{});
+        }
+
+        // verifies the tag in the last 16 of the size bytes and writes the size - 16 bytes of plaintext
+        // to the output, throws AuthenticationError on mismatch without writing anything
+        template <class InitVector, class AdditionalData>
+        void decryptGcm(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                        const InitVector& initVector, const AdditionalData& additionalData) const
+        {
+            if (size < tagByteCount)
+                throw AuthenticationError{"Message too short"};
+
+            const std::size_t dataSize = size - tagByteCount;
+            if (static_cast<std::uint64_t>(dataSize) > gcmMaxDataByteCount)
+                throw DataSizeError{"Data too long"};
+
+            Ghash ghash{getHashKey(), backend == Backend::hardware};
+            const Block initialCounter = getInitialCounter(ghash, initVector);
+
+            const auto tag = getTag(ghash, initialCounter, additionalData, input, dataSize);
+
+            if (!isTagEqual(tag.data(), input + dataSize))
+                throw AuthenticationError{"Authentication failed"};
+
+            Block counter = initialCounter;
+            incrementCounter<gcmCounterByteCount>(counter);
+            applyCounter<gcmCounterByteCount>(counter, input, output, dataSize);
+        }
+
+        // verifies the tag at the end of the data and returns the plaintext, throws AuthenticationError on mismatch
+        template <class Iterator, class InitVector, class AdditionalData>
+        [[nodiscard]]
+        std::vector<std::uint8_t> decryptGcm(Iterator begin, Iterator end,
+                                             const InitVector& initVector,
+                                             const AdditionalData& additionalData) const
+        {
+            auto result = convertToBytes(begin, end);
+            decryptGcm(result.data(), result.size(), result.data(), initVector, additionalData);
+            result.resize(result.size() - tagByteCount);
+            return result;
+        }
+
+        template <class Data, class InitVector, class AdditionalData>
+        [[nodiscard]]
+        std::vector<std::uint8_t> decryptGcm(const Data& data,
+                                             const InitVector& initVector,
+                                             const AdditionalData& additionalData) const
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            return decryptGcm(begin(data), end(data), initVector, additionalData);
+        }
+
+        template <class Data, class InitVector>
+        [[nodiscard]]
+        std::vector<std::uint8_t> decryptGcm(const Data& data, const InitVector& initVector) const
+        {
+            return decryptGcm(data, initVector, std::array<std::uint8_t, 0>{});
+        }
+
+    private:
+        // copies up to parallelBlockCount blocks at a time from the input, zero-padding the last
+        // partial block, calls function(blocks, count) on them and writes them to the output
+        template <class Function>
+        static void processBlocks(const std::uint8_t* input, std::size_t size, std::uint8_t* output,
+                                  const Function& function) noexcept
+        {
+            std::array<Block, parallelBlockCount> blocks;
+            const auto blockBytes = reinterpret_cast<std::uint8_t*>(blocks.data());
+
+            while (size > 0)
+            {
+                const std::size_t byteCount = std::min(size, parallelBlockCount * blockByteCount);
+                const std::size_t count = (byteCount + blockByteCount - 1) / blockByteCount;
+
+                std::memcpy(blockBytes, input, byteCount);
+                std::memset(blockBytes + byteCount, 0, count * blockByteCount - byteCount);
+
+                function(blocks.data(), count);
+
+                std::memcpy(output, blockBytes, count * blockByteCount);
+
+                input += byteCount;
+                output += count * blockByteCount;
+                size -= byteCount;
+            }
+        }
+
+        // runs processBlocks on the chunks of parallelFor, calling function(blocks, count, chainBlock) with
+        // the chain block starting at the initial block or the ciphertext block preceding the chunk
+        template <class Function>
+        void processChained(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                            const Block& initialBlock, const Function& function) const
+        {
+            const std::size_t blockCount = (size + blockByteCount - 1) / blockByteCount;
+            const std::size_t chunkSize = getChunkSize(blockCount, threadCount);
+
+            // saved before the chunks start, as in-place processing overwrites the ciphertext
+            std::vector<Block> chainBlocks((chunkSize < blockCount) ? (blockCount - 1) / chunkSize : 0);
+            for (std::size_t i = 0; i < chainBlocks.size(); ++i)
+                std::memcpy(chainBlocks[i].data(), input + ((i + 1) * chunkSize - 1) * blockByteCount, blockByteCount);
+
+            parallelFor(blockCount, threadCount,
+                        [&](const std::size_t first, const std::size_t last) noexcept {
+                            Block chainBlock = (first == 0) ? initialBlock : chainBlocks[first / chunkSize - 1];
+                            const std::size_t offset = first * blockByteCount;
+                            processBlocks(input + offset, std::min(last * blockByteCount, size) - offset, output + offset,
+                                          [&function, &chainBlock](Block* blocks, const std::size_t count) noexcept {
+                                              function(blocks, count, chainBlock);
+                                          });
+                        });
+        }
+
+        // xors the input with the key stream into the output, generating parallelBlockCount counter blocks at a time
+        template <std::size_t counterByteCount = blockByteCount>
+        void applyCounter(Block counter, const std::uint8_t* input, std::uint8_t* output,
+                          std::size_t size) const noexcept
+        {
+            std::array<Block, parallelBlockCount> keyStream;
+
+            while (size > 0)
+            {
+                const std::size_t count = std::min(parallelBlockCount, (size + blockByteCount - 1) / blockByteCount);
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    keyStream[i] = counter;
+                    incrementCounter<counterByteCount>(counter);
+                }
+
+                encryptBlocks(keyStream.data(), count);
+
+                const std::size_t byteCount = std::min(size, count * blockByteCount);
+                const auto keyStreamBytes = reinterpret_cast<const std::uint8_t*>(keyStream.data());
+                for (std::size_t i = 0; i < byteCount; ++i)
+                    output[i] = static_cast<std::uint8_t>(input[i] ^ keyStreamBytes[i]);
+
+                input += byteCount;
+                output += byteCount;
+                size -= byteCount;
+            }
+        }
+
+        // H = E(K, 0^128)
+        [[nodiscard]] BlockBytes getHashKey() const noexcept
+        {
+            Block hashKey{};
+            encrypt(hashKey);
+            return toBytes(hashKey);
+        }
+
+        // J0 is IV || 0^31 || 1 for 96-bit IVs and GHASH of the IV otherwise, an empty IV would
+        // give J0 = 0 for every key
+        template <class InitVector>
+        [[nodiscard]] Block getInitialCounter(Ghash& ghash, const InitVector& initVector) const
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            const auto initVectorSize = static_cast<std::size_t>(std::distance(begin(initVector), end(initVector)));
+            if (initVectorSize == 0)
+                throw DataSizeError{"Empty initialization vector"};
+
+            if (initVectorSize == gcmInitVectorByteCount)
+            {
+                BlockBytes result{};
+                std::transform(begin(initVector), end(initVector), result.begin(), [](const auto b) noexcept {
+                    return static_cast<std::uint8_t>(b);
+                });
+                result[blockByteCount - 1] = 1;
+                return toBlock(result);
+            }
+
+            ghash.update(begin(initVector), end(initVector));
+            return toBlock(ghash.finalize(0, initVectorSize));
+        }
+
+        template <class AdditionalData>
+        [[nodiscard]] BlockBytes getTag(Ghash& ghash, Block initialCounter,
+                                        const AdditionalData& additionalData,
+                                        const std::uint8_t* encryptedData,
+                                        const std::size_t size) const noexcept
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            ghash.update(begin(additionalData), end(additionalData));
+            ghash.update(encryptedData, size);
+            const auto hash = ghash.finalize(static_cast<std::size_t>(std::distance(begin(additionalData), end(additionalData))), size);
+
+            encrypt(initialCounter);
+            BlockBytes result = toBytes(initialCounter);
+            for (std::size_t i = 0; i < blockByteCount; ++i)
+                result[i] ^= hash[i];
+            return result;
+        }
+
+        // Only the schedule of the backend is filled. The bitsliced one is eight times larger than
+        // the others, so it lives on the heap, shared by the copies of the cipher, instead of
+        // growing every cipher, context and cache entry.
+        Backend backend;
+        std::size_t threadCount = 1;
+        RoundKeys<keyLength> roundKeys{}; // reference, table and hardware
+        RoundKeys<keyLength> decryptionRoundKeys{}; // table and hardware
+        std::shared_ptr<const BitslicedRoundKeys<keyLength>> bitslicedRoundKeys; // bitsliced
+    };
+
+    // Thread-safe bounded cache of ciphers with expanded key schedules, keyed by the key bytes.
+    // The keys are spread over independently locked shards, each evicting with the CLOCK algorithm.
+    // The capacity is split between the shards, so the cache never holds more keys than requested.
+    template <std::size_t keyLength>
+    class KeyCache final
+    {
+    public:
+        static constexpr std::size_t defaultShardCount = 16;
+
+        explicit KeyCache(const std::size_t initCapacity,
+                          const Backend initBackend = getDefaultBackend(),
+                          const std::size_t initShardCount = defaultShardCount):
+            backend{initBackend},
+            capacity{initCapacity},
+            shardCount{std::max(std::size_t{1}, std::min(initShardCount, initCapacity))},
+            shards{std::make_unique<Shard[]>(shardCount)}
+        {
+            if (capacity == 0)
+                throw std::invalid_argument{"Capacity must not be zero"};
+            if (!isSupported(backend))
+                throw BackendError{"Backend not supported"};
+
+            // the first shards take the remainder of the split
+            for (std::size_t i = 0; i < shardCount; ++i)
+                shards[i].capacity = capacity / shardCount + (i < capacity % shardCount ? 1 : 0);
+        }
+
+        [[nodiscard]] Backend getBackend() const noexcept { return backend; }
+        [[nodiscard]] std::size_t getCapacity() const noexcept { return capacity; }
+
+        // returns the cipher for the key, expanding the key schedule only if it is not cached,
+        // the cipher stays valid after being evicted for as long as it is held
+        template <class Key>
+        [[nodiscard]] std::shared_ptr<const Cipher<keyLength>> get(const Key& key)
+        {
+            KeyBytes keyBytes;
+            for (std::size_t i = 0; i < keyBytes.size(); ++i)
+                keyBytes[i] = static_cast<std::uint8_t>(key[i]);
+
+            // the shard is picked by the upper bits of the hash, the map inside uses the lower ones
+            Shard& shard = shards[static_cast<std::size_t>(getHash(keyBytes) >> 32) % shardCount];
+
+            {
+                std::lock_guard<std::mutex> lock{shard.mutex};
+                if (const auto i = shard.indices.find(keyBytes); i != shard.indices.end())
+                {
+                    Entry& entry = shard.entries[i->second];
+                    entry.referenced = true;
+                    ++shard.hitCount;
+                    return entry.cipher;
+                }
+                ++shard.missCount;
+            }
+
+            // the key is expanded without holding the lock
+            auto cipher = std::make_shared<const Cipher<keyLength>>(keyBytes, backend);
+
+            std::lock_guard<std::mutex> lock{shard.mutex};
+            if (const auto i = shard.indices.find(keyBytes); i != shard.indices.end())
+                return shard.entries[i->second].cipher; // inserted by another thread meanwhile
+
+            if (shard.entries.size() < shard.capacity)
+            {
+                shard.indices.emplace(keyBytes, shard.entries.size());
+                shard.entries.push_back(Entry{keyBytes, cipher, false});
+                return cipher;
+            }
+
+            // the hand clears the reference bits until it finds an entry that was not used since its last pass
+            while (shard.entries[shard.hand].referenced)
+            {
+                shard.entries[shard.hand].referenced = false;
+                shard.hand = (shard.hand + 1) % shard.entries.size();
+            }
+
+            Entry& entry = shard.entries[shard.hand];
+            shard.indices.erase(entry.key);
+            shard.indices.emplace(keyBytes, shard.hand);
+            entry = Entry{keyBytes, cipher, false};
+            shard.hand = (shard.hand + 1) % shard.entries.size();
+            return cipher;
+        }
+
+        [[nodiscard]] std::uint64_t getHitCount() const
+        {
+            return sum([](const Shard& shard) noexcept { return shard.hitCount; });
+        }
+
+        [[nodiscard]] std::uint64_t getMissCount() const
+        {
+            return sum([](const Shard& shard) noexcept { return shard.missCount; });
+        }
+
+        [[nodiscard]] std::size_t getSize() const
+        {
+            return static_cast<std::size_t>(sum([](const Shard& shard) noexcept {
+                return static_cast<std::uint64_t>(shard.entries.size());
+            }));
+        }
+
+        // removes all the keys, the counters are kept
+        void clear()
+        {
+            for (std::size_t i = 0; i < shardCount; ++i)
+            {
+                std::lock_guard<std::mutex> lock{shards[i].mutex};
+                shards[i].indices.clear();
+                shards[i].entries.clear();
+                shards[i].hand = 0;
+            }
+        }
+
+    private:
+        using KeyBytes = std::array<std::uint8_t, keyLength / 8>;
+
+        // FNV-1a
+        [[nodiscard]] static std::uint64_t getHash(const KeyBytes& keyBytes) noexcept
+        {
+            std::uint64_t hash = 14695981039346656037ULL;
+            for (const auto b : keyBytes)
+                hash = (hash ^ b) * 1099511628211ULL;
+            return hash;
+        }
+
+        struct KeyHash final
+        {
+            std::size_t operator()(const KeyBytes& keyBytes) const noexcept
+            {
+                return static_cast<std::size_t>(getHash(keyBytes));
+            }
+        };
+
+        struct Entry final
+        {
+            KeyBytes key;
+            std::shared_ptr<const Cipher<keyLength>> cipher;
+            bool referenced;
+        };
+
+        struct Shard final
+        {
+            mutable std::mutex mutex;
+            std::unordered_map<KeyBytes, std::size_t, KeyHash> indices;
+            std::vector<Entry> entries;
+            std::size_t capacity = 0;
+            std::size_t hand = 0;
+            std::uint64_t hitCount = 0;
+            std::uint64_t missCount = 0;
+        };
+
+        template <class Function>
+        [[nodiscard]] std::uint64_t sum(Function function) const
+        {
+            std::uint64_t result = 0;
+            for (std::size_t i = 0; i < shardCount; ++i)
+            {
+                std::lock_guard<std::mutex> lock{shards[i].mutex};
+                result += function(shards[i]);
+            }
+            return result;
+        }
+
+        Backend backend;
+        std::size_t capacity;
+        std::size_t shardCount;
+        std::unique_ptr<Shard[]> shards;
+    };
+
+    enum class Mode
+    {
+        ecb,
+        cbc,
+        cfb,
+        ctr
+    };
+
+    enum class Direction
+    {
+        encryption,
+        decryption
+    };
+
+    // incremental encryption or decryption of data that arrives in pieces, the chaining block
+    // is carried between the update calls and the last partial block is zero-padded by finalize
+    template <std::size_t keyLength, Mode mode, Direction direction>
+    class Context final
+    {
+    public:
+        explicit Context(const Cipher<keyLength>& initCipher) noexcept:
+            cipher{initCipher}
+        {
+            static_assert(mode == Mode::ecb, "Mode requires an initialization vector");
+        }
+
+        template <class InitVector>
+        Context(const Cipher<keyLength>& initCipher, const InitVector& initVector) noexcept:
+            cipher{initCipher}, chainBlock{convertToBlock(initVector)}
+        {
+            static_assert(mode != Mode::ecb, "ECB does not use an initialization vector");
+        }
+
+        // writes the processed bytes of all the complete blocks (all the bytes for CTR)
+        // to the output and returns the iterator past the last written byte
+        template <class Iterator, class OutputIterator>
+        OutputIterator update(Iterator begin, Iterator end, OutputIterator output)
+        {
+            for (auto i = begin; i != end; ++i)
+            {
+                if constexpr (mode == Mode::ctr)
+                {
+                    if (bufferSize == bufferByteCount)
+                        generateKeyStream();
+
+                    *output++ = static_cast<std::uint8_t>(static_cast<std::uint8_t>(*i) ^ getBufferBytes()[bufferSize]);
+                    ++bufferSize;
+                }
+                else
+                {
+                    getBufferBytes()[bufferSize] = static_cast<std::uint8_t>(*i);
+                    if (++bufferSize == blockByteCount)
+                    {
+                        output = process(output);
+                        bufferSize = 0;
+                    }
+                }
+            }
+
+            return output;
+        }
+
+        // the whole blocks between the partial head and tail go through the batched pointer
+        // overloads of the cipher, output may be the same buffer as input
+        std::uint8_t* update(const std::uint8_t* input, std::size_t size, std::uint8_t* output)
+        {
+            if constexpr (mode == Mode::ctr)
+            {
+                // the rest of the key stream generated by the previous call
+                const std::size_t count = std::min(bufferByteCount - bufferSize, size);
+                output = update(input, input + count, output);
+                input += count;
+                size -= count;
+            }
+            else if (bufferSize != 0)
+            {
+                const std::size_t count = std::min(blockByteCount - bufferSize, size);
+                output = update(input, input + count, output);
+                input += count;
+                size -= count;
+            }
+
+            const std::size_t wholeSize = size - size % blockByteCount;
+            if (wholeSize != 0)
+            {
+                // the decryption may overwrite its input
+                Block lastInputBlock{};
+                if constexpr ((mode == Mode::cbc || mode == Mode::cfb) && direction == Direction::decryption)
+                    std::memcpy(getBytes(lastInputBlock), input + wholeSize - blockByteCount, blockByteCount);
+                const BlockBytes chainBytes = toBytes(chainBlock);
+
+                if constexpr (mode == Mode::ecb)
+                {
+                    if constexpr (direction == Direction::encryption)
+                        cipher.encryptEcb(input, wholeSize, output);
+                    else
+                        cipher.decryptEcb(input, wholeSize, output);
+                }
+                else if constexpr (mode == Mode::cbc)
+                {
+                    if constexpr (direction == Direction::encryption)
+                        cipher.encryptCbc(input, wholeSize, output, chainBytes);
+                    else
+                        cipher.decryptCbc(input, wholeSize, output, chainBytes);
+                }
+                else if constexpr (mode == Mode::cfb)
+                {
+                    if constexpr (direction == Direction::encryption)
+                        cipher.encryptCfb(input, wholeSize, output, chainBytes);
+                    else
+                        cipher.decryptCfb(input, wholeSize, output, chainBytes);
+                }
+                else if constexpr (mode == Mode::ctr)
+                {
+                    cipher.encryptCtr(input, wholeSize, output, chainBytes);
+                    addCounter(chainBlock, wholeSize / blockByteCount);
+                }
+
+                // CBC and CFB chain from the last ciphertext block, which is the output of the
+                // encryption and the input of the decryption
+                if constexpr (mode == Mode::cbc || mode == Mode::cfb)
+                {
+                    if constexpr (direction == Direction::encryption)
+                        std::memcpy(getBytes(chainBlock), output + wholeSize - blockByteCount, blockByteCount);
+                    else
+                        chainBlock = lastInputBlock;
+                }
+
+                input += wholeSize;
+                output += wholeSize;
+                size -= wholeSize;
+            }
+
+            return update(input, input + size, output);
+        }
+
+        template <class Data, class OutputIterator>
+        OutputIterator update(const Data& data, OutputIterator output)
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            return update(begin(data), end(data), output);
+        }
+
+        // writes the zero-padded last block, if there is one
+        template <class OutputIterator>
+        OutputIterator finalize(OutputIterator output)
+        {
+            if constexpr (mode != Mode::ctr)
+                if (bufferSize != 0)
+                {
+                    std::fill(getBufferBytes() + bufferSize, getBufferBytes() + blockByteCount, std::uint8_t{0});
+
+                    output = process(output);
+                    bufferSize = 0;
+                }
+
+            return output;
+        }
+
+    private:
+        // CTR buffers the key stream of parallelBlockCount counters, the other modes a single block
+        static constexpr std::size_t bufferBlockCount = (mode == Mode::ctr) ? parallelBlockCount : 1;
+        static constexpr std::size_t bufferByteCount = bufferBlockCount * blockByteCount;
+
+        [[nodiscard]] std::uint8_t* getBufferBytes() noexcept
+        {
+            return reinterpret_cast<std::uint8_t*>(buffer.data());
+        }
+
+        void generateKeyStream() noexcept
+        {
+            for (auto& block : buffer)
+            {
+                block = chainBlock;
+                incrementCounter(chainBlock);
+            }
+
+            cipher.encryptBlocks(buffer.data(), buffer.size());
+            bufferSize = 0;
+        }
+
+        template <class OutputIterator>
+        OutputIterator process(OutputIterator output) noexcept
+        {
+            Block& block = buffer[0];
+
+            if constexpr (mode == Mode::ecb)
+            {
+                if constexpr (direction == Direction::encryption)
+                    cipher.encrypt(block);
+                else
+                    cipher.decrypt(block);
+            }
+            else if constexpr (mode == Mode::cbc)
+            {
+                if constexpr (direction == Direction::encryption)
+                {
+                    chainBlock ^= block;
+                    cipher.encrypt(chainBlock);
+                    block = chainBlock;
+                }
+                else
+                {
+                    const Block encryptedBlock = block;
+                    cipher.decrypt(block);
+                    block ^= chainBlock;
+                    chainBlock = encryptedBlock;
+                }
+            }
+            else if constexpr (mode == Mode::cfb)
+            {
+                const Block inputBlock = block;
+                cipher.encrypt(chainBlock);
+                block ^= chainBlock;
+                chainBlock = (direction == Direction::encryption) ? block : inputBlock;
+            }
+
+            return std::copy(getBytes(block), getBytes(block) + blockByteCount, output);
+        }
+
+        Cipher<keyLength> cipher;
+        Block chainBlock{}; // initialization vector, previous ciphertext block or next counter
+        std::array<Block, bufferBlockCount> buffer{}; // partial input block or, for CTR, the key stream
+        std::size_t bufferSize = (mode == Mode::ctr) ? bufferByteCount : 0;
+    };
+
+    template <std::size_t keyLength, Mode mode>
+    using Encryptor = Context<keyLength, mode, Direction::encryption>;
+
+    template <std::size_t keyLength, Mode mode>
+    using Decryptor = Context<keyLength, mode, Direction::decryption>;
+
+    // XTS-AES (IEEE 1619) for storage, the data is split into data units (sectors) that are
+    // encrypted independently with the data unit number as the tweak, keyLength is the length of
+    // each of the two keys
+    template <std::size_t keyLength>
+    class XtsCipher final
+    {
+    public:
+        // IEEE 1619 allows at most 2^20 blocks per data unit
+        static constexpr std::size_t maxDataUnitSize = (std::size_t{1} << 20) * blockByteCount;
+
+        // the key is the data key followed by the tweak key, the two halves have to differ
+        template <class Key>
+        XtsCipher(const Key& key, const std::size_t initDataUnitSize,
+                  const Backend backend = getDefaultBackend()):
+            dataCipher{getKeyHalf(key, 0), backend},
+            tweakCipher{getKeyHalf(key, 1), backend},
+            dataUnitSize{initDataUnitSize}
+        {
+            if (getKeyHalf(key, 0) == getKeyHalf(key, 1))
+                throw std::invalid_argument{"Data and tweak keys are equal"};
+            if (dataUnitSize < blockByteCount)
+                throw DataSizeError{"Data unit shorter than a block"};
+            if (dataUnitSize > maxDataUnitSize)
+                throw std::invalid_argument{"Data unit longer than 2^20 blocks"};
+        }
+
+        [[nodiscard]] std::size_t getDataUnitSize() const noexcept { return dataUnitSize; }
+
+        // number of threads the data units may be split across
+        [[nodiscard]] std::size_t getThreadCount() const noexcept { return threadCount; }
+        void setThreadCount(const std::size_t newThreadCount) noexcept { threadCount = newThreadCount; }
+
+        // encrypts consecutive data units, the first one with the given number, into the output of the same size
+        // (which may be the input), the last data unit may be shorter but has to hold at least a block
+        void encrypt(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                     const std::uint64_t dataUnitNumber) const
+        {
+            process<true>(input, size, output, dataUnitNumber);
+        }
+
+        template <class Data>
+        [[nodiscard]]
+        std::vector<std::uint8_t> encrypt(const Data& data, const std::uint64_t dataUnitNumber) const
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            auto result = convertToBytes(begin(data), end(data));
+            encrypt(result.data(), result.size(), result.data(), dataUnitNumber);
+            return result;
+        }
+
+        void decrypt(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                     const std::uint64_t dataUnitNumber) const
+        {
+            process<false>(input, size, output, dataUnitNumber);
+        }
+
+        template <class Data>
+        [[nodiscard]]
+        std::vector<std::uint8_t> decrypt(const Data& data, const std::uint64_t dataUnitNumber) const
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            auto result = convertToBytes(begin(data), end(data));
+            decrypt(result.data(), result.size(), result.data(), dataUnitNumber);
+            return result;
+        }
+
+    private:
+        template <class Key>
+        [[nodiscard]] static std::array<std::uint8_t, keyLength / 8> getKeyHalf(const Key& key, const std::size_t half)
+        {
+            std::array<std::uint8_t, keyLength / 8> result;
+            for (std::size_t i = 0; i < result.size(); ++i)
+                result[i] = static_cast<std::uint8_t>(key[half * result.size() + i]);
+            return result;
+        }
+
+        template <bool encryption>
+        void process(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                     const std::uint64_t dataUnitNumber) const
+        {
+            if (size == 0) return;
+
+            const std::size_t dataUnitCount = (size + dataUnitSize - 1) / dataUnitSize;
+            if (size - (dataUnitCount - 1) * dataUnitSize < blockByteCount)
+                throw DataSizeError{"Data unit shorter than a block"};
+
+            parallelFor(dataUnitCount, threadCount,
+                        [this, input, size, output, dataUnitNumber](const std::size_t first, const std::size_t last) noexcept {
+                            std::array<Block, parallelBlockCount> tweaks;
+
+                            for (std::size_t dataUnit = first; dataUnit < last; dataUnit += parallelBlockCount)
+                            {
+                                // the tweaks of several data units are encrypted together
+                                const std::size_t count = std::min(parallelBlockCount, last - dataUnit);
+                                for (std::size_t i = 0; i < count; ++i)
+                                {
+                                    const std::uint64_t number = dataUnitNumber + dataUnit + i;
+                                    tweaks[i] = Block{};
+                                    storeColumn(tweaks[i][0], static_cast<std::uint32_t>(number));
+                                    storeColumn(tweaks[i][1], static_cast<std::uint32_t>(number >> 32));
+                                }
+
+                                tweakCipher.encryptBlocks(tweaks.data(), count);
+
+                                for (std::size_t i = 0; i < count; ++i)
+                                {
+                                    const std::size_t offset = (dataUnit + i) * dataUnitSize;
+                                    processDataUnit<encryption>(input + offset, std::min(dataUnitSize, size - offset),
+                                                                output + offset, tweaks[i]);
+                                }
+                            }
+                        },
+                        (dataUnitSize + blockByteCount - 1) / blockByteCount);
+        }
+
+        // C = E(P ^ T) ^ T with the tweak multiplied by x for every block, ciphertext stealing
+        // takes care of a partial last block
+        template <bool encryption>
+        void processDataUnit(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                             Block tweak) const noexcept
+        {
+            const std::size_t remainder = size % blockByteCount;
+            const std::size_t blockCount = size / blockByteCount - (remainder != 0 ? 1 : 0);
+
+            std::array<Block, parallelBlockCount> blocks;
+            std::array<Block, parallelBlockCount> tweaks;
+
+            for (std::size_t first = 0; first < blockCount; first += parallelBlockCount)
+            {
+                const std::size_t count = std::min(parallelBlockCount, blockCount - first);
+                std::memcpy(blocks.data(), input + first * blockByteCount, count * blockByteCount);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    tweaks[i] = tweak;
+                    multiplyTweak(tweak);
+                    blocks[i] ^= tweaks[i];
+                }
+
+                if constexpr (encryption)
+                    dataCipher.encryptBlocks(blocks.data(), count);
+                else
+                    dataCipher.decryptBlocks(blocks.data(), count);
+
+                for (std::size_t i = 0; i < count; ++i)
+                    blocks[i] ^= tweaks[i];
+
+                std::memcpy(output + first * blockByteCount, blocks.data(), count * blockByteCount);
+            }
+
+            if (remainder != 0)
+            {
+                Block nextTweak = tweak;
+                multiplyTweak(nextTweak);
+
+                // decryption uses the two last tweaks in the opposite order
+                const Block& firstTweak = encryption ? tweak : nextTweak;
+                const Block& secondTweak = encryption ? nextTweak : tweak;
+
+                const std::uint8_t* lastInput = input + blockCount * blockByteCount;
+                std::uint8_t* lastOutput = output + blockCount * blockByteCount;
+
+                Block block;
+                std::memcpy(block.data(), lastInput, blockByteCount);
+                BlockBytes partialBlock;
+                std::memcpy(partialBlock.data(), lastInput + blockByteCount, remainder);
+
+                processBlock<encryption>(block, firstTweak);
+
+                // the partial block steals the tail of the processed last full block
+                std::memcpy(lastOutput + blockByteCount, block.data(), remainder);
+                std::memcpy(block.data(), partialBlock.data(), remainder);
+
+                processBlock<encryption>(block, secondTweak);
+                std::memcpy(lastOutput, block.data(), blockByteCount);
+            }
+        }
+
+        template <bool encryption>
+        void processBlock(Block& block, const Block& tweak) const noexcept
+        {
+            block ^= tweak;
+            if constexpr (encryption)
+                dataCipher.encrypt(block);
+            else
+                dataCipher.decrypt(block);
+            block ^= tweak;
+        }
+
+        Cipher<keyLength> dataCipher;
+        Cipher<keyLength> tweakCipher;
+        std::size_t dataUnitSize;
+        std::size_t threadCount = 1;
+    };
+
+    // AES-CMAC (RFC 4493), a CBC-MAC that keeps only the chaining block and the last partial block,
+    // so messages of any length are authenticated in one pass without allocating
+    template <std::size_t keyLength>
+    class Cmac final
+    {
+    public:
+        template <class Key>
+        explicit Cmac(const Key& key, const Backend backend = getDefaultBackend()):
+            cipher{key, backend}
+        {
+            // K1 = L * x and K2 = L * x^2 with L = E(K, 0^128)
+            cipher.encrypt(subkey1);
+            doubleSubkey(subkey1);
+            subkey2 = subkey1;
+            doubleSubkey(subkey2);
+        }
+
+        // the streaming interface, finalize returns the tag of all the data passed to update
+        // since the construction or the last finalize or reset
+
+        void update(const std::uint8_t* data, const std::size_t size) noexcept
+        {
+            absorb(state, buffer, bufferSize, data, size);
+        }
+
+        template <class Iterator>
+        void update(Iterator begin, Iterator end) noexcept
+        {
+            absorb(state, buffer, bufferSize, begin, end);
+        }
+
+        template <class Data>
+        void update(const Data& data) noexcept
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            update(begin(data), end(data));
+        }
+
+        [[nodiscard]] BlockBytes finalize() noexcept
+        {
+            const auto result = getTag(state, buffer, bufferSize);
+            reset();
+            return result;
+        }
+
+        void reset() noexcept
+        {
+            state = Block{};
+            bufferSize = 0;
+        }
+
+        // one-shot tags, independent of the streaming state
+
+        [[nodiscard]] BlockBytes generate(const std::uint8_t* data, const std::size_t size) const noexcept
+        {
+            Block chainBlock{};
+            Block block{};
+            std::size_t blockSize = 0;
+            absorb(chainBlock, block, blockSize, data, size);
+            return getTag(chainBlock, block, blockSize);
+        }
+
+        template <class Iterator>
+        [[nodiscard]] BlockBytes generate(Iterator begin, Iterator end) const noexcept
+        {
+            Block chainBlock{};
+            Block block{};
+            std::size_t blockSize = 0;
+            absorb(chainBlock, block, blockSize, begin, end);
+            return getTag(chainBlock, block, blockSize);
+        }
+
+        template <class Data>
+        [[nodiscard]] BlockBytes generate(const Data& data) const noexcept
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            return generate(begin(data), end(data));
+        }
+
+        // compares the tags in constant time
+        [[nodiscard]] bool verify(const std::uint8_t* data, const std::size_t size,
+                                  const std::uint8_t* tag) const noexcept
+        {
+            return isTagEqual(generate(data, size).data(), tag);
+        }
+
+        template <class Data, class Tag>
+        [[nodiscard]] bool verify(const Data& data, const Tag& tag) const noexcept
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            if (std::distance(begin(tag), end(tag)) != static_cast<std::ptrdiff_t>(tagByteCount))
+                return false;
+
+            BlockBytes expectedTag{};
+            std::transform(begin(tag), end(tag), expectedTag.begin(), [](const auto b) noexcept {
+                return static_cast<std::uint8_t>(b);
+            });
+            return isTagEqual(generate(data).data(), expectedTag.data());
+        }
+
+        // verifies the tags of several messages in one pass, the blocks of up to parallelBlockCount
+        // messages are encrypted together, and stores in results whether each tag matched
+        void verify(const CmacJob* jobs, const std::size_t count, bool* results) const noexcept
+        {
+            // the active messages are kept packed at the front of the arrays
+            std::array<std::size_t, parallelBlockCount> messages;
+            std::array<std::size_t, parallelBlockCount> offsets;
+            std::array<Block, parallelBlockCount> chainBlocks;
+            std::size_t activeCount = 0;
+            std::size_t nextMessage = 0;
+
+            for (;;)
+            {
+                for (; activeCount < parallelBlockCount && nextMessage < count; ++activeCount)
+                {
+                    messages[activeCount] = nextMessage++;
+                    offsets[activeCount] = 0;
+                    chainBlocks[activeCount] = Block{};
+                }
+
+                if (activeCount == 0) break;
+
+                for (std::size_t i = 0; i < activeCount; ++i)
+                {
+                    const CmacJob& job = jobs[messages[i]];
+                    const std::size_t remaining = job.size - offsets[i];
+
+                    Block block{};
+                    if (remaining > blockByteCount)
+                        std::memcpy(block.data(), job.input + offsets[i], blockByteCount);
+                    else
+                    {
+                        if (remaining != 0)
+                            std::memcpy(block.data(), job.input + offsets[i], remaining);
+                        block = getLastBlock(block, remaining);
+                    }
+
+                    chainBlocks[i] ^= block;
+                    offsets[i] += blockByteCount;
+                }
+
+                cipher.encryptBlocks(chainBlocks.data(), activeCount);
+
+                // finished messages are replaced by the last active one
+                for (std::size_t i = activeCount; i-- > 0;)
+                {
+                    const CmacJob& job = jobs[messages[i]];
+                    if (offsets[i] < job.size) continue;
+
+                    results[messages[i]] = isTagEqual(getBytes(chainBlocks[i]), job.tag);
+
+                    --activeCount;
+                    messages[i] = messages[activeCount];
+                    offsets[i] = offsets[activeCount];
+                    chainBlocks[i] = chainBlocks[activeCount];
+                }
+            }
+        }
+
+    private:
+        // CBC-MACs all full blocks except the last one, which stays in the block
+        void absorb(Block& chainBlock, Block& block, std::size_t& blockSize,
+                    const std::uint8_t* data, std::size_t size) const noexcept
+        {
+            while (size > 0)
+            {
+                if (blockSize == blockByteCount)
+                {
+                    chainBlock ^= block;
+                    cipher.encrypt(chainBlock);
+                    blockSize = 0;
+                }
+
+                const std::size_t count = std::min(blockByteCount - blockSize, size);
+                std::memcpy(getBytes(block) + blockSize, data, count);
+                blockSize += count;
+                data += count;
+                size -= count;
+            }
+        }
+
+        template <class Iterator>
+        void absorb(Block& chainBlock, Block& block, std::size_t& blockSize,
+                    Iterator begin, Iterator end) const noexcept
+        {
+            for (auto i = begin; i != end; ++i)
+            {
+                if (blockSize == blockByteCount)
+                {
+                    chainBlock ^= block;
+                    cipher.encrypt(chainBlock);
+                    blockSize = 0;
+                }
+
+                getBytes(block)[blockSize++] = static_cast<std::uint8_t>(*i);
+            }
+        }
+
+        // a full last block is XORed with K1, a partial one is padded with 10* and XORed with K2
+        [[nodiscard]] Block getLastBlock(Block block, const std::size_t blockSize) const noexcept
+        {
+            if (blockSize == blockByteCount)
+                return block ^ subkey1;
+
+            std::uint8_t* bytes = getBytes(block);
+            bytes[blockSize] = 0x80U;
+            std::fill(bytes + blockSize + 1, bytes + blockByteCount, std::uint8_t{0});
+            return block ^ subkey2;
+        }
+
+        [[nodiscard]] BlockBytes getTag(Block chainBlock, const Block& block,
+                                        const std::size_t blockSize) const noexcept
+        {
+            chainBlock ^= getLastBlock(block, blockSize);
+            cipher.encrypt(chainBlock);
+            return toBytes(chainBlock);
+        }
+
+        Cipher<keyLength> cipher;
+        Block subkey1{};
+        Block subkey2{};
+        Block state{};
+        Block buffer{};
+        std::size_t bufferSize = 0;
+    };
+
+    // Multi-buffer encryption of independent messages, each with its own key of keyLength bits.
+    // On the hardware backend the blocks of up to eight messages go through the AES units together,
+    // so that the chained modes of short messages run as fast as the parallel ones.
+    template <std::size_t keyLength, Mode mode>
+    void encryptBatch(const Job* jobs, const std::size_t count, const Backend backend = getDefaultBackend())
+    {
+        if (!isSupported(backend))
+            throw BackendError{"Backend not supported"};
+
+#ifdef AES_X86
+        if (backend == Backend::hardware)
+        {
+            if constexpr (mode == Mode::ecb)
+                processJobsHardware<keyLength, false, true>(jobs, count,
+                    [](Block&, const Block& inputBlock) noexcept { return inputBlock; },
+                    [](Block&, const Block&, const Block& block) noexcept { return block; });
+            else if constexpr (mode == Mode::cbc)
+                processJobsHardware<keyLength, false, true>(jobs, count,
+                    [](Block& chainBlock, const Block& inputBlock) noexcept {
+                        chainBlock ^= inputBlock;
+                        return chainBlock;
+                    },
+                    [](Block& chainBlock, const Block&, const Block& block) noexcept {
+                        chainBlock = block;
+                        return block;
+                    });
+            else if constexpr (mode == Mode::cfb)
+                processJobsHardware<keyLength, false, true>(jobs, count,
+                    [](Block& chainBlock, const Block&) noexcept { return chainBlock; },
+                    [](Block& chainBlock, const Block& inputBlock, Block block) noexcept {
+                        block ^= inputBlock;
+                        chainBlock = block;
+                        return block;
+                    });
+            else if constexpr (mode == Mode::ctr)
+                processJobsHardware<keyLength, false, false>(jobs, count,
+                    [](Block& chainBlock, const Block&) noexcept {
+                        const Block counter = chainBlock;
+                        incrementCounter(chainBlock);
+                        return counter;
+                    },
+                    [](Block&, const Block& inputBlock, Block block) noexcept {
+                        block ^= inputBlock;
+                        return block;
+                    });
+            return;
+        }
+#endif
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const Job& job = jobs[i];
+            const Cipher<keyLength> cipher{job.key, backend};
+
+            BlockBytes initVector{};
+            if (job.initVector != nullptr)
+                std::copy(job.initVector, job.initVector + blockByteCount, initVector.begin());
+
+            if constexpr (mode == Mode::ecb)
+                cipher.encryptEcb(job.input, job.size, job.output);
+            else if constexpr (mode == Mode::cbc)
+                cipher.encryptCbc(job.input, job.size, job.output, initVector);
+            else if constexpr (mode == Mode::cfb)
+                cipher.encryptCfb(job.input, job.size, job.output, initVector);
+            else if constexpr (mode == Mode::ctr)
+                cipher.encryptCtr(job.input, job.size, job.output, initVector);
+        }
+    }
+
+    template <std::size_t keyLength, Mode mode>
+    void decryptBatch(const Job* jobs, const std::size_t count, const Backend backend = getDefaultBackend())
+    {
+        if (!isSupported(backend))
+            throw BackendError{"Backend not supported"};
+
+#ifdef AES_X86
+        if (backend == Backend::hardware)
+        {
+            if constexpr (mode == Mode::ecb)
+                processJobsHardware<keyLength, true, true>(jobs, count,
+                    [](Block&, const Block& inputBlock) noexcept { return inputBlock; },
+                    [](Block&, const Block&, const Block& block) noexcept { return block; });
+            else if constexpr (mode == Mode::cbc)
+                processJobsHardware<keyLength, true, true>(jobs, count,
+                    [](Block&, const Block& inputBlock) noexcept { return inputBlock; },
+                    [](Block& chainBlock, const Block& inputBlock, Block block) noexcept {
+                        block ^= chainBlock;
+                        chainBlock = inputBlock;
+                        return block;
+                    });
+            else if constexpr (mode == Mode::cfb)
+                processJobsHardware<keyLength, false, true>(jobs, count,
+                    [](Block& chainBlock, const Block&) noexcept { return chainBlock; },
+                    [](Block& chainBlock, const Block& inputBlock, Block block) noexcept {
+                        block ^= inputBlock;
+                        chainBlock = inputBlock;
+                        return block;
+                    });
+            else if constexpr (mode == Mode::ctr)
+                encryptBatch<keyLength, mode>(jobs, count, backend);
+            return;
+        }
+#endif
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const Job& job = jobs[i];
+            const Cipher<keyLength> cipher{job.key, backend};
+
+            BlockBytes initVector{};
+            if (job.initVector != nullptr)
+                std::copy(job.initVector, job.initVector + blockByteCount, initVector.begin());
+
+            if constexpr (mode == Mode::ecb)
+                cipher.decryptEcb(job.input, job.size, job.output);
+            else if constexpr (mode == Mode::cbc)
+                cipher.decryptCbc(job.input, job.size, job.output, initVector);
+            else if constexpr (mode == Mode::cfb)
+                cipher.decryptCfb(job.input, job.size, job.output, initVector);
+            else if constexpr (mode == Mode::ctr)
+                cipher.decryptCtr(job.input, job.size, job.output, initVector);
+        }
+    }
+
+    template <std::size_t keyLength, class Key>
+    void encryptEcb(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                    const Key& key)
+    {
+        Cipher<keyLength>{key}.encryptEcb(input, size, output);
+    }
+
+    template <std::size_t keyLength, class Iterator, class Key>
+    [[nodiscard]]
+    std::vector<std::uint8_t> encryptEcb(Iterator begin, Iterator end, const Key& key)
+    {
+        return Cipher<keyLength>{key}.encryptEcb(begin, end);
+    }
+
+    template <std::size_t keyLength, class Data, class Key>
+    [[nodiscard]]
+    std::vector<std::uint8_t> encryptEcb(const Data& data, const Key& key)
+    {
+        using std::begin, std::end; // add std::begin and std::end to lookup
+        return encryptEcb<keyLength>(begin(data), end(data), key);
+    }
+
+    template <std::size_t keyLength, class Key>
+    void decryptEcb(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                    const Key& key)
+    {
+        Cipher<keyLength>{key}.decryptEcb(input, size, output);
+    }
+
+    template <std::size_t keyLength, class Iterator, class Key>
+    [[nodiscard]]
+    std::vector<std::uint8_t> decryptEcb(Iterator begin, Iterator end, const Key& key)
+    {
+        return Cipher<keyLength>{key}.decryptEcb(begin, end);
+    }
+
+    template <std::size_t keyLength, class Data, class Key>
+    [[nodiscard]]
+    std::vector<std::uint8_t> decryptEcb(const Data& data, const Key& key)
+    {
+        using std::begin, std::end; // add std::begin and std::end to lookup
+        return decryptEcb<keyLength>(begin(data), end(data), key);
+    }
+
+    template <std::size_t keyLength, class Key, class InitVector>
+    void encryptCbc(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                    const Key& key, const InitVector& initVector)
+    {
+        Cipher<keyLength>{key}.encryptCbc(input, size, output, initVector);
+    }
+
+    template <std::size_t keyLength, class Iterator, class Key, class InitVector>
+    [[nodiscard]]
+    std::vector<std::uint8_t> encryptCbc(Iterator begin, Iterator end, const Key& key,
+                                         const InitVector& initVector)
+    {
+        return Cipher<keyLength>{key}.encryptCbc(begin, end, initVector);
+    }
+
+    template <std::size_t keyLength, class Data, class Key, class InitVector>
+    [[nodiscard]]
+    std::vector<std::uint8_t> encryptCbc(const Data& data, const Key& key,
+                                         const InitVector& initVector)
+    {
+        using std::begin, std::end; // add std::begin and std::end to lookup
+        return encryptCbc<keyLength>(begin(data), end(data), key, initVector);
+    }
+
+    template <std::size_t keyLength, class Key, class InitVector>
+    void decryptCbc(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                    const Key& key, const InitVector& initVector)
+    {
+        Cipher<keyLength>{key}.decryptCbc(input, size, output, initVector);
+    }
+
+    template <std::size_t keyLength, class Iterator, class Key, class InitVector>
+    [[nodiscard]]
+    std::vector<std::uint8_t> decryptCbc(Iterator begin, Iterator end, const Key& key,
+                                         const InitVector& initVector)
+    {
+        return Cipher<keyLength>{key}.decryptCbc(begin, end, initVector);
+    }
+
+    template <std::size_t keyLength, class Data, class Key, class InitVector>
+    [[nodiscard]]
+    std::vector<std::uint8_t> decryptCbc(const Data& data, const Key& key,
+                                         const InitVector& initVector)
+    {
+        using std::begin, std::end; // add std::begin and std::end to lookup
+        return decryptCbc<keyLength>(begin(data), end(data), key, initVector);
+    }
+
+    template <std::size_t keyLength, class Key, class InitVector>
+    void encryptCfb(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                    const Key& key, const InitVector& initVector)
+    {
+        Cipher<keyLength>{key}.encryptCfb(input, size, output, initVector);
+    }
+
+    template <std::size_t keyLength, class Iterator, class Key, class InitVector>
+    [[nodiscard]]
+    std::vector<std::uint8_t> encryptCfb(Iterator begin, Iterator end, const Key& key,
+                                         const InitVector& initVector)
+    {
+        return Cipher<keyLength>{key}.encryptCfb(begin, end, initVector);
+    }
+
+    template <std::size_t keyLength, class Data, class Key, class InitVector>
+    [[nodiscard]]
+    std::vector<std::uint8_t> encryptCfb(const Data& data, const Key& key,
+                                         const InitVector& initVector)
+    {
+        return encryptCfb<keyLength>(std::begin(data), std::end(data), key, initVector);
+    }
+
+    template <std::size_t keyLength, class Key, class InitVector>
+    void decryptCfb(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                    const Key& key, const InitVector& initVector)
+    {
+        Cipher<keyLength>{key}.decryptCfb(input, size, output, initVector);
+    }
+
+    template <std::size_t keyLength, class Iterator, class Key, class InitVector>
+    [[nodiscard]]
+    std::vector<std::uint8_t> decryptCfb(Iterator begin, Iterator end, const Key& key,
+                                         const InitVector& initVector)
+    {
+        return Cipher<keyLength>{key}.decryptCfb(begin, end, initVector);
+    }
+
+    template <std::size_t keyLength, class Data, class Key, class InitVector>
     [[nodiscard]]
     std::vector<std::uint8_t> decryptCfb(const Data& data, const Key& key,
                                          const InitVector& initVector)
@@ -603,6 +3663,280 @@ namespace aes
         using std::begin, std::end; // add std::begin and std::end to lookup
         return decryptCfb<keyLength>(begin(data), end(data), key, initVector);
     }
+
+    template <std::size_t keyLength, class Key, class InitVector, class AdditionalData>
+    void encryptGcm(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                    const Key& key, const InitVector& initVector,
+                    const AdditionalData& additionalData)
+    {
+        Cipher<keyLength>{key}.encryptGcm(input, size, output, initVector, additionalData);
+    }
+
+    template <std::size_t keyLength, class Iterator, class Key, class InitVector, class AdditionalData>
+    [[nodiscard]]
+    std::vector<std::uint8_t> encryptGcm(Iterator begin, Iterator end, const Key& key,
+                                         const InitVector& initVector,
+                                         const AdditionalData& additionalData)
+    {
+        return Cipher<keyLength>{key}.encryptGcm(begin, end, initVector, additionalData);
+    }
+
+    template <std::size_t keyLength, class Data, class Key, class InitVector, class AdditionalData>
+    [[nodiscard]]
+    std::vector<std::uint8_t> encryptGcm(const Data& data, const Key& key,
+                                         const InitVector& initVector,
+                                         const AdditionalData& additionalData)
+    {
+        return Cipher<keyLength>{key}.encryptGcm(data, initVector, additionalData);
+    }
+
+    template <std::size_t keyLength, class Data, class Key, class InitVector>
+    [[nodiscard]]
+    std::vector<std::uint8_t> encryptGcm(const Data& data, const Key& key,
+                                         const InitVector& initVector)
+    {
+        return Cipher<keyLength>{key}.encryptGcm(data, initVector);
+    }
+
+    template <std::size_t keyLength, class Key, class InitVector, class AdditionalData>
+    void decryptGcm(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                    const Key& key, const InitVector& initVector,
+                    const AdditionalData& additionalData)
+    {
+        Cipher<keyLength>{key}.decryptGcm(input, size, output, initVector, additionalData);
+    }
+
+    template <std::size_t keyLength, class Iterator, class Key, class InitVector, class AdditionalData>
+    [[nodiscard]]
+    std::vector<std::uint8_t> decryptGcm(Iterator begin, Iterator end, const Key& key,
+                                         const InitVector& initVector,
+                                         const AdditionalData& additionalData)
+    {
+        return Cipher<keyLength>{key}.decryptGcm(begin, end, initVector, additionalData);
+    }
+
+    template <std::size_t keyLength, class Data, class Key, class InitVector, class AdditionalData>
+    [[nodiscard]]
+    std::vector<std::uint8_t> decryptGcm(const Data& data, const Key& key,
+                                         const InitVector& initVector,
+                                         const AdditionalData& additionalData)
+    {
+        return Cipher<keyLength>{key}.decryptGcm(data, initVector, additionalData);
+    }
+
+    template <std::size_t keyLength, class Data, class Key, class InitVector>
+    [[nodiscard]]
+    std::vector<std::uint8_t> decryptGcm(const Data& data, const Key& key,
+                                         const InitVector& initVector)
+    {
+        return Cipher<keyLength>{key}.decryptGcm(data, initVector);
+    }
+
+    template <std::size_t keyLength, class Key, class InitVector>
+    void encryptCtr(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                    const Key& key, const InitVector& initVector)
+    {
+        Cipher<keyLength>{key}.encryptCtr(input, size, output, initVector);
+    }
+
+    template <std::size_t keyLength, class Iterator, class Key, class InitVector>
+    [[nodiscard]]
+    std::vector<std::uint8_t> encryptCtr(Iterator begin, Iterator end, const Key& key,
+                                         const InitVector& initVector)
+    {
+        return Cipher<keyLength>{key}.encryptCtr(begin, end, initVector);
+    }
+
+    template <std::size_t keyLength, class Data, class Key, class InitVector>
+    [[nodiscard]]
+    std::vector<std::uint8_t> encryptCtr(const Data& data, const Key& key,
+                                         const InitVector& initVector)
+    {
+        using std::begin, std::end; // add std::begin and std::end to lookup
+        return encryptCtr<keyLength>(begin(data), end(data), key, initVector);
+    }
+
+    template <std::size_t keyLength, class Key, class InitVector>
+    void decryptCtr(const std::uint8_t* input, const std::size_t size, std::uint8_t* output,
+                    const Key& key, const InitVector& initVector)
+    {
+        Cipher<keyLength>{key}.decryptCtr(input, size, output, initVector);
+    }
+
+    template <std::size_t keyLength, class Iterator, class Key, class InitVector>
+    [[nodiscard]]
+    std::vector<std::uint8_t> decryptCtr(Iterator begin, Iterator end, const Key& key,
+                                         const InitVector& initVector)
+    {
+        return Cipher<keyLength>{key}.decryptCtr(begin, end, initVector);
+    }
+
+    template <std::size_t keyLength, class Data, class Key, class InitVector>
+    [[nodiscard]]
+    std::vector<std::uint8_t> decryptCtr(const Data& data, const Key& key,
+                                         const InitVector& initVector)
+    {
+        using std::begin, std::end; // add std::begin and std::end to lookup
+        return decryptCtr<keyLength>(begin(data), end(data), key, initVector);
+    }
+
+    template <std::size_t keyLength, class Data, class Key>
+    [[nodiscard]]
+    std::vector<std::uint8_t> encryptXts(const Data& data, const Key& key,
+                                         const std::size_t dataUnitSize,
+                                         const std::uint64_t dataUnitNumber)
+    {
+        return XtsCipher<keyLength>{key, dataUnitSize}.encrypt(data, dataUnitNumber);
+    }
+
+    template <std::size_t keyLength, class Data, class Key>
+    [[nodiscard]]
+    std::vector<std::uint8_t> decryptXts(const Data& data, const Key& key,
+                                         const std::size_t dataUnitSize,
+                                         const std::uint64_t dataUnitNumber)
+    {
+        return XtsCipher<keyLength>{key, dataUnitSize}.decrypt(data, dataUnitNumber);
+    }
+
+    template <std::size_t keyLength, class Data, class Key>
+    [[nodiscard]]
+    BlockBytes generateCmac(const Data& data, const Key& key)
+    {
+        return Cmac<keyLength>{key}.generate(data);
+    }
+
+    template <std::size_t keyLength, class Data, class Key, class Tag>
+    [[nodiscard]]
+    bool verifyCmac(const Data& data, const Key& key, const Tag& tag)
+    {
+        return Cmac<keyLength>{key}.verify(data, tag);
+    }
+
+    template <std::size_t keyLength, class Key>
+    void verifyCmac(const CmacJob* jobs, const std::size_t count, bool* results, const Key& key)
+    {
+        Cmac<keyLength>{key}.verify(jobs, count, results);
+    }
+
+    // The array variants of ECB, CBC and CFB can be evaluated in constant expressions, for example
+    // to embed encrypted data in the binary. They use the table rounds and zero-pad the last block.
+
+    template <std::size_t keyLength, class T, std::size_t size, class Key>
+    [[nodiscard]]
+    constexpr std::array<std::uint8_t, getPaddedSize(size)> encryptEcbArray(const std::array<T, size>& data,
+                                                                            const Key& key) noexcept
+    {
+        RoundKeys<keyLength> roundKeys{};
+        expandKey<keyLength>(key, roundKeys);
+
+        std::array<std::uint8_t, getPaddedSize(size)> result{};
+        for (std::size_t offset = 0; offset < size; offset += blockByteCount)
+        {
+            Block block = loadBlock(data, size, offset);
+            encryptBlockTable<keyLength>(block, roundKeys);
+            storeBlock(result, offset, block);
+        }
+        return result;
+    }
+
+    template <std::size_t keyLength, class T, std::size_t size, class Key>
+    [[nodiscard]]
+    constexpr std::array<std::uint8_t, getPaddedSize(size)> decryptEcbArray(const std::array<T, size>& data,
+                                                                            const Key& key) noexcept
+    {
+        const auto decryptionRoundKeys = expandDecryptionKey<keyLength>(key);
+
+        std::array<std::uint8_t, getPaddedSize(size)> result{};
+        for (std::size_t offset = 0; offset < size; offset += blockByteCount)
+        {
+            Block block = loadBlock(data, size, offset);
+            decryptBlockTable<keyLength>(block, decryptionRoundKeys);
+            storeBlock(result, offset, block);
+        }
+        return result;
+    }
+
+    template <std::size_t keyLength, class T, std::size_t size, class Key, class InitVector>
+    [[nodiscard]]
+    constexpr std::array<std::uint8_t, getPaddedSize(size)> encryptCbcArray(const std::array<T, size>& data,
+                                                                            const Key& key,
+                                                                            const InitVector& initVector) noexcept
+    {
+        RoundKeys<keyLength> roundKeys{};
+        expandKey<keyLength>(key, roundKeys);
+
+        std::array<std::uint8_t, getPaddedSize(size)> result{};
+        Block chainBlock = loadBlock(initVector, blockByteCount, 0);
+        for (std::size_t offset = 0; offset < size; offset += blockByteCount)
+        {
+            chainBlock ^= loadBlock(data, size, offset);
+            encryptBlockTable<keyLength>(chainBlock, roundKeys);
+            storeBlock(result, offset, chainBlock);
+        }
+        return result;
+    }
+
+    template <std::size_t keyLength, class T, std::size_t size, class Key, class InitVector>
+    [[nodiscard]]
+    constexpr std::array<std::uint8_t, getPaddedSize(size)> decryptCbcArray(const std::array<T, size>& data,
+                                                                            const Key& key,
+                                                                            const InitVector& initVector) noexcept
+    {
+        const auto decryptionRoundKeys = expandDecryptionKey<keyLength>(key);
+
+        std::array<std::uint8_t, getPaddedSize(size)> result{};
+        Block chainBlock = loadBlock(initVector, blockByteCount, 0);
+        for (std::size_t offset = 0; offset < size; offset += blockByteCount)
+        {
+            const Block encryptedBlock = loadBlock(data, size, offset);
+            Block block = encryptedBlock;
+            decryptBlockTable<keyLength>(block, decryptionRoundKeys);
+            storeBlock(result, offset, block ^ chainBlock);
+            chainBlock = encryptedBlock;
+        }
+        return result;
+    }
+
+    template <std::size_t keyLength, class T, std::size_t size, class Key, class InitVector>
+    [[nodiscard]]
+    constexpr std::array<std::uint8_t, getPaddedSize(size)> encryptCfbArray(const std::array<T, size>& data,
+                                                                            const Key& key,
+                                                                            const InitVector& initVector) noexcept
+    {
+        RoundKeys<keyLength> roundKeys{};
+        expandKey<keyLength>(key, roundKeys);
+
+        std::array<std::uint8_t, getPaddedSize(size)> result{};
+        Block chainBlock = loadBlock(initVector, blockByteCount, 0);
+        for (std::size_t offset = 0; offset < size; offset += blockByteCount)
+        {
+            encryptBlockTable<keyLength>(chainBlock, roundKeys);
+            chainBlock ^= loadBlock(data, size, offset);
+            storeBlock(result, offset, chainBlock);
+        }
+        return result;
+    }
+
+    template <std::size_t keyLength, class T, std::size_t size, class Key, class InitVector>
+    [[nodiscard]]
+    constexpr std::array<std::uint8_t, getPaddedSize(size)> decryptCfbArray(const std::array<T, size>& data,
+                                                                            const Key& key,
+                                                                            const InitVector& initVector) noexcept
+    {
+        RoundKeys<keyLength> roundKeys{};
+        expandKey<keyLength>(key, roundKeys);
+
+        std::array<std::uint8_t, getPaddedSize(size)> result{};
+        Block chainBlock = loadBlock(initVector, blockByteCount, 0);
+        for (std::size_t offset = 0; offset < size; offset += blockByteCount)
+        {
+            const Block encryptedBlock = loadBlock(data, size, offset);
+            encryptBlockTable<keyLength>(chainBlock, roundKeys);
+            storeBlock(result, offset, chainBlock ^ encryptedBlock);
+            chainBlock = encryptedBlock;
+        }
+        return result;
+    }
 }
 
 #endif // AES_HPP
@@ -0,0 +1,233 @@
+//
+// Header-only libs
+//
+
+#ifndef AES_FILE_HPP
+#define AES_FILE_HPP
+
+#if defined(_WIN32)
+#  error "aes_file.hpp requires POSIX mmap"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "aes.hpp"
+
+namespace aes
+{
+    class FileError final: public std::system_error
+    {
+    public:
+        using system_error::system_error;
+    };
+
+    inline namespace detail
+    {
+        // the files are mapped and processed in windows of this size, a multiple of the page and block sizes,
+        // so that only a window of each file is resident at a time
+        constexpr std::size_t fileChunkSize = 16 * 1024 * 1024;
+
+        class FileDescriptor final
+        {
+        public:
+            FileDescriptor(const std::string& path, const int flags, const mode_t mode = 0666):
+                descriptor{::open(path.c_str(), flags, mode)}
+            {
+                if (descriptor == -1)
+                    throw FileError{errno, std::system_category(), "Failed to open " + path};
+            }
+
+            ~FileDescriptor()
+            {
+                ::close(descriptor);
+            }
+
+            FileDescriptor(const FileDescriptor&) = delete;
+            FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+            [[nodiscard]] int get() const noexcept { return descriptor; }
+
+            [[nodiscard]] std::size_t getSize() const
+            {
+                struct stat status;
+                if (::fstat(descriptor, &status) == -1)
+                    throw FileError{errno, std::system_category(), "Failed to get the file size"};
+                return static_cast<std::size_t>(status.st_size);
+            }
+
+            void resize(const std::size_t size) const
+            {
+                if (::ftruncate(descriptor, static_cast<off_t>(size)) == -1)
+                    throw FileError{errno, std::system_category(), "Failed to resize the file"};
+            }
+
+        private:
+            int descriptor;
+        };
+
+        class FileMapping final
+        {
+        public:
+            FileMapping(const FileDescriptor& file, const int protection,
+                        const std::size_t offset, const std::size_t initSize):
+                size{initSize}
+            {
+                void* address = ::mmap(nullptr, size, protection, MAP_SHARED, file.get(), static_cast<off_t>(offset));
+                if (address == MAP_FAILED)
+                    throw FileError{errno, std::system_category(), "Failed to map the file"};
+
+                data = static_cast<std::uint8_t*>(address);
+
+                // the window is read once from the start to the end, so the kernel can read ahead
+                // and drop the pages behind
+                ::madvise(address, size, MADV_SEQUENTIAL);
+            }
+
+            ~FileMapping()
+            {
+                ::munmap(data, size);
+            }
+
+            FileMapping(const FileMapping&) = delete;
+            FileMapping& operator=(const FileMapping&) = delete;
+
+            [[nodiscard]] std::uint8_t* getData() const noexcept { return data; }
+
+        private:
+            std::uint8_t* data = nullptr;
+            std::size_t size;
+        };
+
+        // Processes the input file into the output one (which may be the same file) window by window,
+        // carrying the chaining block or counter from one window to the next. The block modes
+        // zero-pad the last block, so the output is getPaddedSize bytes long, CTR keeps the size.
+        template <std::size_t keyLength, Mode mode, bool encryption, class Key, class InitVector>
+        void processFile(const FileDescriptor& input, const FileDescriptor* output,
+                         const Key& key, const InitVector& initVector,
+                         const std::size_t threadCount, const Backend backend)
+        {
+            const std::size_t size = input.getSize();
+            const std::size_t outputSize = (mode == Mode::ctr) ? size : getPaddedSize(size);
+
+            const FileDescriptor& outputFile = output != nullptr ? *output : input;
+            if (output != nullptr || outputSize != size)
+                outputFile.resize(outputSize);
+
+            Cipher<keyLength> cipher{key, backend};
+            cipher.setThreadCount(threadCount);
+
+            Block chainBlock{};
+            if constexpr (mode != Mode::ecb)
+                chainBlock = convertToBlock(initVector);
+
+            for (std::size_t offset = 0; offset < size; offset += fileChunkSize)
+            {
+                const std::size_t chunkSize = std::min(fileChunkSize, size - offset);
+
+                const FileMapping outputMapping{outputFile, PROT_READ | PROT_WRITE, offset,
+                                                std::min(fileChunkSize, outputSize - offset)};
+
+                std::optional<FileMapping> inputMapping;
+                if (output != nullptr)
+                    inputMapping.emplace(input, PROT_READ, offset, chunkSize);
+
+                const std::uint8_t* inputData = inputMapping ? inputMapping->getData() : outputMapping.getData();
+                std::uint8_t* outputData = outputMapping.getData();
+
+                const BlockBytes chainBytes = toBytes(chainBlock);
+
+                // the next window of a decryption chains from the last ciphertext block, which
+                // the in-place decryption overwrites, all the windows but the last hold whole blocks
+                if constexpr (!encryption && (mode == Mode::cbc || mode == Mode::cfb))
+                    if (chunkSize >= blockByteCount)
+                        std::memcpy(chainBlock.data(), inputData + chunkSize - blockByteCount, blockByteCount);
+
+                if constexpr (mode == Mode::ecb)
+                {
+                    if constexpr (encryption)
+                        cipher.encryptEcb(inputData, chunkSize, outputData);
+                    else
+                        cipher.decryptEcb(inputData, chunkSize, outputData);
+                }
+                else if constexpr (mode == Mode::cbc)
+                {
+                    if constexpr (encryption)
+                        cipher.encryptCbc(inputData, chunkSize, outputData, chainBytes);
+                    else
+                        cipher.decryptCbc(inputData, chunkSize, outputData, chainBytes);
+                }
+                else if constexpr (mode == Mode::cfb)
+                {
+                    if constexpr (encryption)
+                        cipher.encryptCfb(inputData, chunkSize, outputData, chainBytes);
+                    else
+                        cipher.decryptCfb(inputData, chunkSize, outputData, chainBytes);
+                }
+                else if constexpr (mode == Mode::ctr)
+                {
+                    cipher.encryptCtr(inputData, chunkSize, outputData, chainBytes);
+                    addCounter(chainBlock, chunkSize / blockByteCount);
+                }
+
+                if constexpr (encryption && (mode == Mode::cbc || mode == Mode::cfb))
+                    if (chunkSize >= blockByteCount)
+                        std::memcpy(chainBlock.data(), outputData + chunkSize - blockByteCount, blockByteCount);
+            }
+        }
+    }
+
+    // The file functions map the files window by window instead of reading them into memory and
+    // split every window across threadCount threads in the modes that can be parallelized
+    // (ECB, CTR and the CBC and CFB decryption). The initialization vector is not used by ECB,
+    // the output file is created or truncated and must not be the input file.
+
+    template <std::size_t keyLength, Mode mode, class Key, class InitVector = BlockBytes>
+    void encryptFile(const std::string& inputPath, const std::string& outputPath,
+                     const Key& key, const InitVector& initVector = InitVector{},
+                     const std::size_t threadCount = 1, const Backend backend = getDefaultBackend())
+    {
+        const FileDescriptor input{inputPath, O_RDONLY};
+        const FileDescriptor output{outputPath, O_RDWR | O_CREAT | O_TRUNC};
+        processFile<keyLength, mode, true>(input, &output, key, initVector, threadCount, backend);
+    }
+
+    template <std::size_t keyLength, Mode mode, class Key, class InitVector = BlockBytes>
+    void decryptFile(const std::string& inputPath, const std::string& outputPath,
+                     const Key& key, const InitVector& initVector = InitVector{},
+                     const std::size_t threadCount = 1, const Backend backend = getDefaultBackend())
+    {
+        const FileDescriptor input{inputPath, O_RDONLY};
+        const FileDescriptor output{outputPath, O_RDWR | O_CREAT | O_TRUNC};
+        processFile<keyLength, mode, false>(input, &output, key, initVector, threadCount, backend);
+    }
+
+    template <std::size_t keyLength, Mode mode, class Key, class InitVector = BlockBytes>
+    void encryptFileInPlace(const std::string& path, const Key& key,
+                            const InitVector& initVector = InitVector{},
+                            const std::size_t threadCount = 1, const Backend backend = getDefaultBackend())
+    {
+        const FileDescriptor file{path, O_RDWR};
+        processFile<keyLength, mode, true>(file, nullptr, key, initVector, threadCount, backend);
+    }
+
+    template <std::size_t keyLength, Mode mode, class Key, class InitVector = BlockBytes>
+    void decryptFileInPlace(const std::string& path, const Key& key,
+                            const InitVector& initVector = InitVector{},
+                            const std::size_t threadCount = 1, const Backend backend = getDefaultBackend())
+    {
+        const FileDescriptor file{path, O_RDWR};
+        processFile<keyLength, mode, false>(file, nullptr, key, initVector, threadCount, backend);
+    }
+}
+
+#endif // AES_FILE_HPP
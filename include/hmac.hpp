@@ -0,0 +1,151 @@
+//
+// Header-only libs
+//
+
+#ifndef HMAC_HPP
+#define HMAC_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+namespace hmac
+{
+    // HMAC (RFC 2104) over a hasher with the given block and digest sizes. The key padded with
+    // ipad and opad is hashed once on construction and every message continues from copies of
+    // those two hashers, which saves the two compressions of the padded key on every message.
+    template <class Hasher, std::size_t blockByteCount, std::size_t digestByteCount>
+    class BasicHmac final
+    {
+    public:
+        using Digest = std::array<std::uint8_t, digestByteCount>;
+
+        template <class Key>
+        explicit BasicHmac(const Key& key) noexcept
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+
+            std::array<std::uint8_t, blockByteCount> paddedKey{};
+            std::size_t keySize = 0;
+            for (auto i = begin(key); i != end(key); ++i, ++keySize)
+                if (keySize < blockByteCount)
+                    paddedKey[keySize] = static_cast<std::uint8_t>(*i);
+
+            // keys longer than a block are replaced by their hash
+            if (keySize > blockByteCount)
+            {
+                Hasher keyHasher;
+                keyHasher.update(key);
+                const Digest keyDigest = keyHasher.finalize();
+                std::fill(std::copy(keyDigest.begin(), keyDigest.end(), paddedKey.begin()), paddedKey.end(), 0);
+            }
+
+            for (auto& b : paddedKey) b = static_cast<std::uint8_t>(b ^ 0x36U);
+            innerHasher.update(paddedKey.data(), paddedKey.size());
+
+            for (auto& b : paddedKey) b = static_cast<std::uint8_t>(b ^ 0x36U ^ 0x5CU);
+            outerHasher.update(paddedKey.data(), paddedKey.size());
+
+            messageHasher = innerHasher;
+        }
+
+        // the streaming interface, finalize returns the HMAC of all the data passed to update
+        // since the construction or the last finalize or reset
+
+        void update(const std::uint8_t* data, const std::size_t size) noexcept
+        {
+            messageHasher.update(data, size);
+        }
+
+        template <class Iterator>
+        void update(const Iterator begin, const Iterator end) noexcept
+        {
+            messageHasher.update(begin, end);
+        }
+
+        template <class Data>
+        void update(const Data& data) noexcept
+        {
+            messageHasher.update(data);
+        }
+
+        [[nodiscard]] Digest finalize() noexcept
+        {
+            const Digest result = getResult(messageHasher);
+            reset();
+            return result;
+        }
+
+        void reset() noexcept
+        {
+            messageHasher = innerHasher;
+        }
+
+        // one-shot HMACs, independent of the streaming state
+
+        [[nodiscard]] Digest generate(const std::uint8_t* data, const std::size_t size) const noexcept
+        {
+            Hasher hasher = innerHasher;
+            hasher.update(data, size);
+            return getResult(hasher);
+        }
+
+        template <class Iterator>
+        [[nodiscard]] Digest generate(const Iterator begin, const Iterator end) const noexcept
+        {
+            Hasher hasher = innerHasher;
+            hasher.update(begin, end);
+            return getResult(hasher);
+        }
+
+        template <class Data>
+        [[nodiscard]] Digest generate(const Data& data) const noexcept
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            return generate(begin(data), end(data));
+        }
+
+        // compares the HMACs in constant time
+        [[nodiscard]] bool verify(const std::uint8_t* data, const std::size_t size,
+                                  const std::uint8_t* tag) const noexcept
+        {
+            return isTagEqual(generate(data, size), tag);
+        }
+
+        template <class Data, class Tag>
+        [[nodiscard]] bool verify(const Data& data, const Tag& tag) const noexcept
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            if (std::distance(begin(tag), end(tag)) != static_cast<std::ptrdiff_t>(digestByteCount))
+                return false;
+
+            return isTagEqual(generate(data), begin(tag));
+        }
+
+    private:
+        template <class Iterator>
+        [[nodiscard]] static bool isTagEqual(const Digest& expectedTag, Iterator tag) noexcept
+        {
+            std::uint8_t difference = 0;
+            for (std::size_t i = 0; i < digestByteCount; ++i, ++tag)
+                difference |= static_cast<std::uint8_t>(static_cast<std::uint8_t>(*tag) ^ expectedTag[i]);
+            return difference == 0;
+        }
+
+        [[nodiscard]] Digest getResult(Hasher& hasher) const noexcept
+        {
+            const Digest innerDigest = hasher.finalize();
+            Hasher hasherCopy = outerHasher;
+            hasherCopy.update(innerDigest.data(), innerDigest.size());
+            return hasherCopy.finalize();
+        }
+
+        Hasher innerHasher;
+        Hasher outerHasher;
+        Hasher messageHasher;
+    };
+}
+
+#endif // HMAC_HPP
@@ -7,8 +7,32 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "hmac.hpp"
+#include "multibuffer.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define MD5_X86
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  else
+#    include <cpuid.h>
+#    include <immintrin.h>
+#  endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define MD5_TARGET(features) __attribute__((target(features)))
+#else
+#  define MD5_TARGET(features)
+#endif
 
 namespace md5
 {
@@ -56,7 +80,7 @@ namespace md5
         using Block = std::array<std::uint8_t, blockByteCount>;
         using State = std::array<std::uint32_t, digestIntCount>;
 
-        inline void transform(const Block& block,
+        inline void transform(const std::uint8_t* block,
                               State& state) noexcept
         {
             std::array<std::uint32_t, 16> w;
@@ -110,65 +134,428 @@ namespace md5
             state[2] += c;
             state[3] += d;
         }
-    }
 
-    template <class Iterator>
-    [[nodiscard]]
-    std::array<std::uint8_t, digestByteCount> hash(const Iterator begin,
-                                                   const Iterator end) noexcept
-    {
-        State state{
+        constexpr State initialState{
             0x67452301U,
             0xEFCDAB89U,
             0x98BADCFEU,
             0x10325476U
         };
 
-        Block block;
-        std::size_t dataSize = 0;
-        for (auto i = begin; i != end; ++i)
+        // the bytes of the iterators that point into contiguous memory can be hashed in place
+        template <class T>
+        constexpr bool isByte = sizeof(T) == 1 && !std::is_same_v<T, bool> &&
+            (std::is_integral_v<T> || std::is_same_v<T, std::byte>);
+
+        template <class Iterator, class Value = std::remove_cv_t<typename std::iterator_traits<Iterator>::value_type>>
+        constexpr bool isContiguousByteIterator = isByte<Value> &&
+            (std::is_pointer_v<Iterator> ||
+             std::is_same_v<Iterator, typename std::vector<Value>::iterator> ||
+             std::is_same_v<Iterator, typename std::vector<Value>::const_iterator> ||
+             std::is_same_v<Iterator, std::string::iterator> ||
+             std::is_same_v<Iterator, std::string::const_iterator>);
+
+        inline void transformBlocks(const std::uint8_t* data,
+                                    const std::size_t blockCount,
+                                    State& state) noexcept
+        {
+            for (std::size_t i = 0; i < blockCount; ++i)
+                transform(data + i * blockByteCount, state);
+        }
+
+        // a message hashed by hashBatch, the digest receives digestByteCount bytes
+        using Job = multibuffer::Job;
+
+        // The multi-buffer transforms hash one block of laneCount independent messages at a time,
+        // one message per vector lane. The state is stored word by word, laneCount lanes per word.
+        template <std::size_t laneCount>
+        using LaneState = std::array<std::uint32_t, digestIntCount * laneCount>;
+
+        template <std::size_t laneCount>
+        using LaneWords = std::array<std::uint32_t, blockIntCount * laneCount>;
+
+        template <std::size_t laneCount>
+        LaneWords<laneCount> loadLaneWords(const std::uint8_t* const* blocks) noexcept
+        {
+            return multibuffer::loadLaneWords<laneCount, multibuffer::ByteOrder::littleEndian>(blocks);
+        }
+
+#ifdef MD5_X86
+        struct CpuFeatures final
+        {
+            bool sse2 = false;
+            bool avx2 = false;
+            bool avx512 = false;
+        };
+
+        [[nodiscard]] inline CpuFeatures detectCpuFeatures() noexcept
+        {
+            CpuFeatures result;
+#  if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            const int maxLeaf = info[0];
+            __cpuid(info, 1);
+            const auto ecx = static_cast<unsigned int>(info[2]);
+            const auto edx = static_cast<unsigned int>(info[3]);
+            result.sse2 = (edx & (1U << 26)) != 0;
+            if (maxLeaf < 7) return result;
+            __cpuidex(info, 7, 0);
+            const auto ebx = static_cast<unsigned int>(info[1]);
+#  else
+            unsigned int eax = 0;
+            unsigned int ebx = 0;
+            unsigned int ecx = 0;
+            unsigned int edx = 0;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+                return result;
+            result.sse2 = (edx & (1U << 26)) != 0;
+            const unsigned int leaf1Ecx = ecx;
+            if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+                return result;
+            ecx = leaf1Ecx;
+#  endif
+            // the wide registers can only be used if the OS saves them on context switches
+            if ((ecx & (1U << 27)) == 0) return result; // OSXSAVE
+#  if defined(_MSC_VER)
+            const auto xcr0 = static_cast<std::uint64_t>(_xgetbv(0));
+#  else
+            unsigned int xcr0Low = 0;
+            unsigned int xcr0High = 0;
+            __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+            const std::uint64_t xcr0 = (static_cast<std::uint64_t>(xcr0High) << 32) | xcr0Low;
+#  endif
+            const bool avxState = (xcr0 & 0x06U) == 0x06U; // XMM and YMM
+            const bool avx512State = (xcr0 & 0xE6U) == 0xE6U; // and opmask and ZMM
+            result.avx2 = avxState && (ebx & (1U << 5)) != 0;
+            result.avx512 = avx512State && (ebx & (1U << 16)) != 0;
+            return result;
+        }
+
+        [[nodiscard]] inline const CpuFeatures& getCpuFeatures() noexcept
+        {
+            static const CpuFeatures cpuFeatures = detectCpuFeatures();
+            return cpuFeatures;
+        }
+
+        MD5_TARGET("sse2")
+        inline __m128i rotateLeft(const __m128i value, const int bits) noexcept
+        {
+            return _mm_or_si128(_mm_sll_epi32(value, _mm_cvtsi32_si128(bits)),
+                                _mm_srl_epi32(value, _mm_cvtsi32_si128(32 - bits)));
+        }
+
+        MD5_TARGET("avx2")
+        inline __m256i rotateLeft(const __m256i value, const int bits) noexcept
+        {
+            return _mm256_or_si256(_mm256_sll_epi32(value, _mm_cvtsi32_si128(bits)),
+                                   _mm256_srl_epi32(value, _mm_cvtsi32_si128(32 - bits)));
+        }
+
+        // the masked form with all the lanes set avoids the GCC 12 -Wmaybe-uninitialized false
+        // positive of the unmasked one and compiles to the same instruction
+        MD5_TARGET("avx512f")
+        inline __m512i rotateLeft(const __m512i value, const int bits) noexcept
+        {
+            return _mm512_maskz_rolv_epi32(0xFFFF, value, _mm512_set1_epi32(bits));
+        }
+
+        MD5_TARGET("sse2")
+        inline void transformLanesSse2(const std::uint8_t* const* blocks, LaneState<4>& state) noexcept
+        {
+            const LaneWords<4> words = loadLaneWords<4>(blocks);
+
+            __m128i w[blockIntCount];
+            for (std::size_t i = 0; i < blockIntCount; ++i)
+                w[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&words[i * 4]));
+
+            __m128i v[digestIntCount];
+            for (std::size_t i = 0; i < digestIntCount; ++i)
+                v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[i * 4]));
+
+            for (std::size_t i = 0; i < 64; ++i)
+            {
+                // the registers are renamed instead of moved, the new b is written over a
+                __m128i& a = v[(68 - i) % 4];
+                const __m128i& b = v[(69 - i) % 4];
+                const __m128i& c = v[(70 - i) % 4];
+                const __m128i& d = v[(71 - i) % 4];
+
+                __m128i f;
+                std::size_t g = 0;
+
+                if (i < 16)
+                {
+                    f = _mm_or_si128(_mm_and_si128(b, c), _mm_andnot_si128(b, d));
+                    g = i;
+                }
+                else if (i < 32)
+                {
+                    f = _mm_or_si128(_mm_and_si128(d, b), _mm_andnot_si128(d, c));
+                    g = (5 * i + 1) % 16;
+                }
+                else if (i < 48)
+                {
+                    f = _mm_xor_si128(_mm_xor_si128(b, c), d);
+                    g = (3 * i + 5) % 16;
+                }
+                else
+                {
+                    f = _mm_xor_si128(c, _mm_or_si128(b, _mm_xor_si128(d, _mm_set1_epi32(-1))));
+                    g = (7 * i) % 16;
+                }
+
+                f = _mm_add_epi32(_mm_add_epi32(f, a), _mm_add_epi32(_mm_set1_epi32(static_cast<int>(k[i])), w[g]));
+                a = _mm_add_epi32(b, rotateLeft(f, s[i / 16 * 4 + i % 4]));
+            }
+
+            for (std::size_t i = 0; i < digestIntCount; ++i)
+            {
+                const __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[i * 4]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[i * 4]), _mm_add_epi32(previous, v[i]));
+            }
+        }
+
+        MD5_TARGET("avx2")
+        inline void transformLanesAvx2(const std::uint8_t* const* blocks, LaneState<8>& state) noexcept
+        {
+            const LaneWords<8> words = loadLaneWords<8>(blocks);
+
+            __m256i w[blockIntCount];
+            for (std::size_t i = 0; i < blockIntCount; ++i)
+                w[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&words[i * 8]));
+
+            __m256i v[digestIntCount];
+            for (std::size_t i = 0; i < digestIntCount; ++i)
+                v[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&state[i * 8]));
+
+            for (std::size_t i = 0; i < 64; ++i)
+            {
+                // the registers are renamed instead of moved, the new b is written over a
+                __m256i& a = v[(68 - i) % 4];
+                const __m256i& b = v[(69 - i) % 4];
+                const __m256i& c = v[(70 - i) % 4];
+                const __m256i& d = v[(71 - i) % 4];
+
+                __m256i f;
+                std::size_t g = 0;
+
+                if (i < 16)
+                {
+                    f = _mm256_or_si256(_mm256_and_si256(b, c), _mm256_andnot_si256(b, d));
+                    g = i;
+                }
+                else if (i < 32)
+                {
+                    f = _mm256_or_si256(_mm256_and_si256(d, b), _mm256_andnot_si256(d, c));
+                    g = (5 * i + 1) % 16;
+                }
+                else if (i < 48)
+                {
+                    f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+                    g = (3 * i + 5) % 16;
+                }
+                else
+                {
+                    f = _mm256_xor_si256(c, _mm256_or_si256(b, _mm256_xor_si256(d, _mm256_set1_epi32(-1))));
+                    g = (7 * i) % 16;
+                }
+
+                f = _mm256_add_epi32(_mm256_add_epi32(f, a), _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(k[i])), w[g]));
+                a = _mm256_add_epi32(b, rotateLeft(f, s[i / 16 * 4 + i % 4]));
+            }
+
+            for (std::size_t i = 0; i < digestIntCount; ++i)
+            {
+                const __m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&state[i * 8]));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(&state[i * 8]), _mm256_add_epi32(previous, v[i]));
+            }
+        }
+
+        MD5_TARGET("avx512f")
+        inline void transformLanesAvx512(const std::uint8_t* const* blocks, LaneState<16>& state) noexcept
         {
-            block[dataSize % blockByteCount] = static_cast<std::uint8_t>(*i);
-            if (++dataSize % blockByteCount == 0)
-                transform(block, state);
+            const LaneWords<16> words = loadLaneWords<16>(blocks);
+
+            __m512i w[blockIntCount];
+            for (std::size_t i = 0; i < blockIntCount; ++i)
+                w[i] = _mm512_loadu_si512(&words[i * 16]);
+
+            __m512i v[digestIntCount];
+            for (std::size_t i = 0; i < digestIntCount; ++i)
+                v[i] = _mm512_loadu_si512(&state[i * 16]);
+
+            for (std::size_t i = 0; i < 64; ++i)
+            {
+                // the registers are renamed instead of moved, the new b is written over a
+                __m512i& a = v[(68 - i) % 4];
+                const __m512i& b = v[(69 - i) % 4];
+                const __m512i& c = v[(70 - i) % 4];
+                const __m512i& d = v[(71 - i) % 4];
+
+                // 0xCA picks the second or the third operand by the first one, 0x96 is a three-way
+                // xor and 0x39 is c ^ (b | ~d)
+                __m512i f;
+                std::size_t g = 0;
+
+                if (i < 16)
+                {
+                    f = _mm512_ternarylogic_epi32(b, c, d, 0xCA);
+                    g = i;
+                }
+                else if (i < 32)
+                {
+                    f = _mm512_ternarylogic_epi32(d, b, c, 0xCA);
+                    g = (5 * i + 1) % 16;
+                }
+                else if (i < 48)
+                {
+                    f = _mm512_ternarylogic_epi32(b, c, d, 0x96);
+                    g = (3 * i + 5) % 16;
+                }
+                else
+                {
+                    f = _mm512_ternarylogic_epi32(b, c, d, 0x39);
+                    g = (7 * i) % 16;
+                }
+
+                f = _mm512_add_epi32(_mm512_add_epi32(f, a), _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(k[i])), w[g]));
+                a = _mm512_add_epi32(b, rotateLeft(f, s[i / 16 * 4 + i % 4]));
+            }
+
+            for (std::size_t i = 0; i < digestIntCount; ++i)
+            {
+                const __m512i previous = _mm512_loadu_si512(&state[i * 16]);
+                _mm512_storeu_si512(&state[i * 16], _mm512_add_epi32(previous, v[i]));
+            }
         }
+#endif
 
-        // pad data left in the buffer
-        const std::size_t n = dataSize % blockByteCount;
-        block[n] = 0x80;
-        if (n < blockByteCount - 8)
+        // the lane scheduler shared with sha2.hpp, in multibuffer.hpp
+        template <std::size_t laneCount, class Transform>
+        void hashLanes(const Job* jobs, const std::size_t count, const Transform transform) noexcept
         {
-            std::fill(block.begin() + n + 1, block.end() - 8, 0);
+            multibuffer::hashLanes<laneCount, multibuffer::ByteOrder::littleEndian>(jobs, count, initialState, transform);
         }
-        else
+    }
+
+    // incremental hashing of data that arrives in pieces, finalize returns the digest of all
+    // the data passed to update since the construction or the last finalize or reset
+    class Hasher final
+    {
+    public:
+        template <class Iterator>
+        void update(const Iterator begin, const Iterator end) noexcept
         {
-            std::fill(block.begin() + n + 1, block.end(), 0);
-            transform(block, state);
-            std::fill(block.begin(), block.end() - 8, 0);
+            if constexpr (isContiguousByteIterator<Iterator>)
+            {
+                if (begin != end)
+                    update(reinterpret_cast<const std::uint8_t*>(std::addressof(*begin)),
+                           static_cast<std::size_t>(end - begin));
+            }
+            else
+            {
+                for (auto i = begin; i != end; ++i)
+                {
+                    block[dataSize % blockByteCount] = static_cast<std::uint8_t>(*i);
+                    if (++dataSize % blockByteCount == 0)
+                        transform(block.data(), state);
+                }
+            }
         }
 
-        // append the size in bits
-        const std::uint64_t totalBits = dataSize * 8;
-        block[56] = static_cast<std::uint8_t>(totalBits);
-        block[57] = static_cast<std::uint8_t>(totalBits >> 8);
-        block[58] = static_cast<std::uint8_t>(totalBits >> 16);
-        block[59] = static_cast<std::uint8_t>(totalBits >> 24);
-        block[60] = static_cast<std::uint8_t>(totalBits >> 32);
-        block[61] = static_cast<std::uint8_t>(totalBits >> 40);
-        block[62] = static_cast<std::uint8_t>(totalBits >> 48);
-        block[63] = static_cast<std::uint8_t>(totalBits >> 56);
-        transform(block, state);
+        // whole blocks are hashed straight from the data, only a partial block is copied to the buffer
+        void update(const std::uint8_t* data, std::size_t size) noexcept
+        {
+            const std::size_t offset = dataSize % blockByteCount;
+            dataSize += size;
+
+            if (offset != 0)
+            {
+                const std::size_t count = std::min(blockByteCount - offset, size);
+                std::copy(data, data + count, block.begin() + offset);
+                if (offset + count < blockByteCount) return;
+
+                transform(block.data(), state);
+                data += count;
+                size -= count;
+            }
+
+            const std::size_t blockCount = size / blockByteCount;
+            transformBlocks(data, blockCount, state);
+            data += blockCount * blockByteCount;
+            std::copy(data, data + size % blockByteCount, block.begin());
+        }
 
-        std::array<std::uint8_t, digestByteCount> result;
-        for (std::uint32_t i = 0; i < digestIntCount; ++i)
+        template <class T>
+        void update(const T& v) noexcept
         {
-            result[i * 4 + 0] = static_cast<std::uint8_t>(state[i]);
-            result[i * 4 + 1] = static_cast<std::uint8_t>(state[i] >> 8);
-            result[i * 4 + 2] = static_cast<std::uint8_t>(state[i] >> 16);
-            result[i * 4 + 3] = static_cast<std::uint8_t>(state[i] >> 24);
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            update(begin(v), end(v));
         }
 
-        return result;
+        [[nodiscard]]
+        std::array<std::uint8_t, digestByteCount> finalize() noexcept
+        {
+            // pad data left in the buffer
+            const std::size_t n = dataSize % blockByteCount;
+            block[n] = 0x80;
+            if (n < blockByteCount - 8)
+            {
+                std::fill(block.begin() + n + 1, block.end() - 8, 0);
+            }
+            else
+            {
+                std::fill(block.begin() + n + 1, block.end(), 0);
+                transform(block.data(), state);
+                std::fill(block.begin(), block.end() - 8, 0);
+            }
+
+            // append the size in bits
+            const std::uint64_t totalBits = dataSize * 8;
+            block[56] = static_cast<std::uint8_t>(totalBits);
+            block[57] = static_cast<std::uint8_t>(totalBits >> 8);
+            block[58] = static_cast<std::uint8_t>(totalBits >> 16);
+            block[59] = static_cast<std::uint8_t>(totalBits >> 24);
+            block[60] = static_cast<std::uint8_t>(totalBits >> 32);
+            block[61] = static_cast<std::uint8_t>(totalBits >> 40);
+            block[62] = static_cast<std::uint8_t>(totalBits >> 48);
+            block[63] = static_cast<std::uint8_t>(totalBits >> 56);
+            transform(block.data(), state);
+
+            std::array<std::uint8_t, digestByteCount> result;
+            for (std::uint32_t i = 0; i < digestIntCount; ++i)
+            {
+                result[i * 4 + 0] = static_cast<std::uint8_t>(state[i]);
+                result[i * 4 + 1] = static_cast<std::uint8_t>(state[i] >> 8);
+                result[i * 4 + 2] = static_cast<std::uint8_t>(state[i] >> 16);
+                result[i * 4 + 3] = static_cast<std::uint8_t>(state[i] >> 24);
+            }
+
+            reset();
+            return result;
+        }
+
+        void reset() noexcept
+        {
+            state = initialState;
+            dataSize = 0;
+        }
+
+    private:
+        State state = initialState;
+        Block block{};
+        std::uint64_t dataSize = 0;
+    };
+
+    template <class Iterator>
+    [[nodiscard]]
+    std::array<std::uint8_t, digestByteCount> hash(const Iterator begin,
+                                                   const Iterator end) noexcept
+    {
+        Hasher hasher;
+        hasher.update(begin, end);
+        return hasher.finalize();
     }
 
     template <class T>
@@ -178,6 +565,58 @@ namespace md5
         using std::begin, std::end; // add std::begin and std::end to lookup
         return hash(begin(v), end(v));
     }
+
+    // Hashes the independent messages of the jobs, 16, 8 or 4 at a time in the vector lanes when
+    // the CPU has AVX-512, AVX2 or SSE2 and one at a time otherwise. Writes digestByteCount bytes
+    // to the digest of every job.
+    inline void hashBatch(const Job* jobs, const std::size_t count) noexcept
+    {
+#ifdef MD5_X86
+        const CpuFeatures& cpuFeatures = getCpuFeatures();
+        if (cpuFeatures.avx512)
+        {
+            hashLanes<16>(jobs, count, transformLanesAvx512);
+            return;
+        }
+
+        if (cpuFeatures.avx2)
+        {
+            hashLanes<8>(jobs, count, transformLanesAvx2);
+            return;
+        }
+
+        if (cpuFeatures.sse2)
+        {
+            hashLanes<4>(jobs, count, transformLanesSse2);
+            return;
+        }
+#endif
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Hasher hasher;
+            hasher.update(jobs[i].data, jobs[i].size);
+            const auto digest = hasher.finalize();
+            std::copy(digest.begin(), digest.end(), jobs[i].digest);
+        }
+    }
+
+    // HMAC-MD5 (RFC 2104 and RFC 2202)
+    using Hmac = hmac::BasicHmac<Hasher, blockByteCount, digestByteCount>;
+
+    template <class Data, class Key>
+    [[nodiscard]]
+    std::array<std::uint8_t, digestByteCount> generateHmac(const Data& data, const Key& key) noexcept
+    {
+        return Hmac{key}.generate(data);
+    }
+
+    template <class Data, class Key, class Tag>
+    [[nodiscard]]
+    bool verifyHmac(const Data& data, const Key& key, const Tag& tag) noexcept
+    {
+        return Hmac{key}.verify(data, tag);
+    }
 }
 
 #endif // MD5_HPP
@@ -0,0 +1,156 @@
+//
+// Header-only libs
+//
+
+#ifndef MULTIBUFFER_HPP
+#define MULTIBUFFER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace multibuffer
+{
+    // a message hashed by hashBatch, the digest receives digestByteCount bytes
+    struct Job final
+    {
+        const std::uint8_t* data = nullptr;
+        std::size_t size = 0;
+        std::uint8_t* digest = nullptr;
+    };
+
+    inline namespace detail
+    {
+        // MD5 and SHA-256 both use 64-byte blocks of 32-bit words ending in a 64-bit length,
+        // they only differ in the byte order of the words
+        constexpr std::size_t blockByteCount = 64;
+        constexpr std::size_t blockIntCount = blockByteCount / 4;
+
+        enum class ByteOrder
+        {
+            littleEndian,
+            bigEndian
+        };
+
+        template <ByteOrder byteOrder>
+        [[nodiscard]] std::uint32_t loadWord(const std::uint8_t* bytes) noexcept
+        {
+            if constexpr (byteOrder == ByteOrder::littleEndian)
+                return static_cast<std::uint32_t>(bytes[0]) |
+                    (static_cast<std::uint32_t>(bytes[1]) << 8) |
+                    (static_cast<std::uint32_t>(bytes[2]) << 16) |
+                    (static_cast<std::uint32_t>(bytes[3]) << 24);
+            else
+                return (static_cast<std::uint32_t>(bytes[0]) << 24) |
+                    (static_cast<std::uint32_t>(bytes[1]) << 16) |
+                    (static_cast<std::uint32_t>(bytes[2]) << 8) |
+                    static_cast<std::uint32_t>(bytes[3]);
+        }
+
+        template <ByteOrder byteOrder>
+        void storeWord(const std::uint32_t word, std::uint8_t* bytes) noexcept
+        {
+            for (std::size_t i = 0; i < 4; ++i)
+                bytes[i] = static_cast<std::uint8_t>(word >> (byteOrder == ByteOrder::littleEndian ? i * 8 : 24 - i * 8));
+        }
+
+        // The multi-buffer transforms hash one block of laneCount independent messages at a time,
+        // one message per vector lane. The words are interleaved, laneCount lanes per word.
+        template <std::size_t laneCount, ByteOrder byteOrder>
+        std::array<std::uint32_t, blockIntCount * laneCount> loadLaneWords(const std::uint8_t* const* blocks) noexcept
+        {
+            std::array<std::uint32_t, blockIntCount * laneCount> result;
+            for (std::size_t lane = 0; lane < laneCount; ++lane)
+                for (std::size_t i = 0; i < blockIntCount; ++i)
+                    result[i * laneCount + lane] = loadWord<byteOrder>(blocks[lane] + i * 4);
+            return result;
+        }
+
+        // Keeps laneCount jobs in the lanes of the transform and refills a lane with the next job
+        // as soon as its message ends, so the messages of unequal lengths keep all the lanes busy.
+        // The whole blocks are read from the messages, the padded tails from a buffer of every lane.
+        template <std::size_t laneCount, ByteOrder byteOrder, std::size_t digestIntCount, class Transform>
+        void hashLanes(const Job* jobs, const std::size_t count,
+                       const std::array<std::uint32_t, digestIntCount>& initialState,
+                       const Transform transform) noexcept
+        {
+            struct Lane final
+            {
+                const Job* job = nullptr;
+                std::size_t blockIndex = 0;
+                std::size_t fullBlockCount = 0;
+                std::size_t blockCount = 0;
+                std::array<std::uint8_t, blockByteCount * 2> tail;
+            };
+
+            std::array<Lane, laneCount> lanes;
+            std::array<std::uint32_t, digestIntCount * laneCount> state{}; // the idle lanes still run the transform
+            std::array<const std::uint8_t*, laneCount> blocks;
+            const std::array<std::uint8_t, blockByteCount> emptyBlock{};
+
+            std::size_t nextJob = 0;
+            std::size_t activeCount = 0;
+
+            const auto start = [&](const std::size_t index) noexcept {
+                Lane& lane = lanes[index];
+                const Job& job = jobs[nextJob++];
+                lane.job = &job;
+                lane.blockIndex = 0;
+                lane.fullBlockCount = job.size / blockByteCount;
+
+                const std::size_t remaining = job.size % blockByteCount;
+                const std::size_t tailBlockCount = (remaining < blockByteCount - 8) ? 1 : 2;
+                lane.blockCount = lane.fullBlockCount + tailBlockCount;
+
+                std::copy(job.data + lane.fullBlockCount * blockByteCount, job.data + job.size, lane.tail.begin());
+                lane.tail[remaining] = 0x80;
+                const auto lengthBegin = lane.tail.begin() + static_cast<std::ptrdiff_t>(tailBlockCount * blockByteCount - 8);
+                std::fill(lane.tail.begin() + static_cast<std::ptrdiff_t>(remaining + 1), lengthBegin, 0);
+                const std::uint64_t totalBits = static_cast<std::uint64_t>(job.size) * 8;
+                for (std::size_t i = 0; i < 8; ++i)
+                    lengthBegin[static_cast<std::ptrdiff_t>(i)] = static_cast<std::uint8_t>(
+                        totalBits >> (byteOrder == ByteOrder::littleEndian ? i * 8 : 56 - i * 8));
+
+                for (std::size_t i = 0; i < digestIntCount; ++i)
+                    state[i * laneCount + index] = initialState[i];
+            };
+
+            for (std::size_t index = 0; index < laneCount && nextJob < count; ++index, ++activeCount)
+                start(index);
+
+            while (activeCount > 0)
+            {
+                for (std::size_t index = 0; index < laneCount; ++index)
+                {
+                    const Lane& lane = lanes[index];
+                    if (lane.job == nullptr)
+                        blocks[index] = emptyBlock.data();
+                    else if (lane.blockIndex < lane.fullBlockCount)
+                        blocks[index] = lane.job->data + lane.blockIndex * blockByteCount;
+                    else
+                        blocks[index] = lane.tail.data() + (lane.blockIndex - lane.fullBlockCount) * blockByteCount;
+                }
+
+                transform(blocks.data(), state);
+
+                for (std::size_t index = 0; index < laneCount; ++index)
+                {
+                    Lane& lane = lanes[index];
+                    if (lane.job == nullptr || ++lane.blockIndex < lane.blockCount) continue;
+
+                    for (std::size_t i = 0; i < digestIntCount; ++i)
+                        storeWord<byteOrder>(state[i * laneCount + index], lane.job->digest + i * 4);
+
+                    lane.job = nullptr;
+                    if (nextJob < count)
+                        start(index);
+                    else
+                        --activeCount;
+                }
+            }
+        }
+    }
+}
+
+#endif // MULTIBUFFER_HPP
@@ -7,8 +7,32 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "hmac.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define SHA1_X86
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  else
+#    include <cpuid.h>
+#    include <immintrin.h>
+#  endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define SHA1_TARGET(features) __attribute__((target(features)))
+#else
+#  define SHA1_TARGET(features)
+#endif
 
 namespace sha1
 {
@@ -28,7 +52,7 @@ namespace sha1
             return (value << bits) | ((value & 0xFFFFFFFFU) >> (32 - bits));
         }
 
-        inline void transform(const Block& block,
+        inline void transform(const std::uint8_t* block,
                               State& state) noexcept
         {
             std::array<std::uint32_t, 80> w;
@@ -87,14 +111,8 @@ namespace sha1
             state[3] += d;
             state[4] += e;
         }
-    }
 
-    template <class Iterator>
-    [[nodiscard]]
-    std::array<std::uint8_t, digestByteCount> hash(const Iterator begin,
-                                                   const Iterator end) noexcept
-    {
-        State state{
+        constexpr State initialState{
             0x67452301U,
             0xEFCDAB89U,
             0x98BADCFEU,
@@ -102,53 +120,265 @@ namespace sha1
             0xC3D2E1F0U
         };
 
-        std::vector<std::uint8_t> buffer;
-        Block block;
-        std::size_t dataSize = 0;
-        for (auto i = begin; i != end; ++i)
+        // the bytes of the iterators that point into contiguous memory can be hashed in place
+        template <class T>
+        constexpr bool isByte = sizeof(T) == 1 && !std::is_same_v<T, bool> &&
+            (std::is_integral_v<T> || std::is_same_v<T, std::byte>);
+
+        template <class Iterator, class Value = std::remove_cv_t<typename std::iterator_traits<Iterator>::value_type>>
+        constexpr bool isContiguousByteIterator = isByte<Value> &&
+            (std::is_pointer_v<Iterator> ||
+             std::is_same_v<Iterator, typename std::vector<Value>::iterator> ||
+             std::is_same_v<Iterator, typename std::vector<Value>::const_iterator> ||
+             std::is_same_v<Iterator, std::string::iterator> ||
+             std::is_same_v<Iterator, std::string::const_iterator>);
+
+#ifdef SHA1_X86
+        struct CpuFeatures final
+        {
+            bool sha = false;
+        };
+
+        [[nodiscard]] inline CpuFeatures detectCpuFeatures() noexcept
         {
-            block[dataSize % blockByteCount] = static_cast<std::uint8_t>(*i);
-            if (++dataSize % blockByteCount == 0)
-                transform(block, state);
+            CpuFeatures result;
+#  if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7) return result;
+            __cpuid(info, 1);
+            const auto ecx = static_cast<unsigned int>(info[2]);
+            __cpuidex(info, 7, 0);
+            const auto ebx = static_cast<unsigned int>(info[1]);
+#  else
+            unsigned int eax = 0;
+            unsigned int ebx = 0;
+            unsigned int ecx = 0;
+            unsigned int edx = 0;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+                return result;
+            const unsigned int leaf1Ecx = ecx;
+            if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+                return result;
+            ecx = leaf1Ecx;
+#  endif
+            const bool ssse3 = (ecx & (1U << 9)) != 0;
+            const bool sse41 = (ecx & (1U << 19)) != 0;
+            result.sha = ssse3 && sse41 && (ebx & (1U << 29)) != 0;
+            return result;
         }
 
-        // pad data left in the buffer
-        const std::size_t n = dataSize % blockByteCount;
-        block[n] = 0x80;
-        if (n < blockByteCount - 8)
+        [[nodiscard]] inline const CpuFeatures& getCpuFeatures() noexcept
         {
-            std::fill(block.begin() + n + 1, block.end() - 8, 0);
+            static const CpuFeatures cpuFeatures = detectCpuFeatures();
+            return cpuFeatures;
         }
-        else
+
+        // Four rounds and one step of the message schedule. The round index is a template argument,
+        // so the immediate of sha1rnds4, the message registers and the schedule steps are all fixed
+        // at compile time and the 20 groups of a block unroll into straight-line code.
+        template <std::size_t i>
+        SHA1_TARGET("sha,sse4.1,ssse3")
+        inline void roundsHardware(__m128i& abcd, __m128i& previousA, const __m128i e, __m128i* messages) noexcept
         {
-            std::fill(block.begin() + n + 1, block.end(), 0);
-            transform(block, state);
-            std::fill(block.begin(), block.end() - 8, 0);
+            const __m128i message = messages[i % 4];
+            __m128i roundInput;
+            if constexpr (i == 0)
+                roundInput = _mm_add_epi32(e, message);
+            else
+                roundInput = _mm_sha1nexte_epu32(previousA, message);
+            previousA = abcd;
+            abcd = _mm_sha1rnds4_epu32(abcd, roundInput, i / 5);
+
+            // w[t] = rotateLeft(w[t - 3] ^ w[t - 8] ^ w[t - 14] ^ w[t - 16], 1)
+            if constexpr (i >= 1 && i <= 16)
+                messages[(i + 3) % 4] = _mm_sha1msg1_epu32(messages[(i + 3) % 4], message);
+            if constexpr (i >= 2 && i <= 17)
+                messages[(i + 2) % 4] = _mm_xor_si128(messages[(i + 2) % 4], message);
+            if constexpr (i >= 3 && i <= 18)
+                messages[(i + 1) % 4] = _mm_sha1msg2_epu32(messages[(i + 1) % 4], message);
         }
 
-        // append the size in bits
-        const std::uint64_t totalBits = dataSize * 8;
-        block[63] = static_cast<std::uint8_t>(totalBits);
-        block[62] = static_cast<std::uint8_t>(totalBits >> 8);
-        block[61] = static_cast<std::uint8_t>(totalBits >> 16);
-        block[60] = static_cast<std::uint8_t>(totalBits >> 24);
-        block[59] = static_cast<std::uint8_t>(totalBits >> 32);
-        block[58] = static_cast<std::uint8_t>(totalBits >> 40);
-        block[57] = static_cast<std::uint8_t>(totalBits >> 48);
-        block[56] = static_cast<std::uint8_t>(totalBits >> 56);
-        transform(block, state);
-
-        std::array<std::uint8_t, digestByteCount> result;
-        // reverse all the bytes to big endian
-        for (std::uint32_t i = 0; i < digestIntCount; ++i)
+        template <std::size_t... i>
+        SHA1_TARGET("sha,sse4.1,ssse3")
+        inline void roundsHardware(__m128i& abcd, __m128i& previousA, const __m128i e, __m128i* messages,
+                                   std::index_sequence<i...>) noexcept
         {
-            result[i * 4 + 0] = static_cast<std::uint8_t>(state[i] >> 24);
-            result[i * 4 + 1] = static_cast<std::uint8_t>(state[i] >> 16);
-            result[i * 4 + 2] = static_cast<std::uint8_t>(state[i] >> 8);
-            result[i * 4 + 3] = static_cast<std::uint8_t>(state[i]);
+            (roundsHardware<i>(abcd, previousA, e, messages), ...);
         }
 
-        return result;
+        // SHA extensions run four rounds per sha1rnds4, sha1nexte derives the next E from the
+        // previous A and adds it to the next four words, the message schedule is four words per
+        // sha1msg1, xor and sha1msg2
+        SHA1_TARGET("sha,sse4.1,ssse3")
+        inline void transformBlocksHardware(const std::uint8_t* data,
+                                            const std::size_t blockCount,
+                                            State& state) noexcept
+        {
+            const __m128i byteSwapMask = _mm_set_epi64x(0x0001020304050607LL, 0x08090A0B0C0D0E0FLL);
+
+            __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0])), 0x1B);
+            __m128i e = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+
+            for (std::size_t b = 0; b < blockCount; ++b, data += blockByteCount)
+            {
+                const __m128i abcdSave = abcd;
+                const __m128i eSave = e;
+
+                __m128i messages[4] = {
+                    _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), byteSwapMask),
+                    _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)), byteSwapMask),
+                    _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)), byteSwapMask),
+                    _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)), byteSwapMask)
+                };
+
+                __m128i previousA = abcd;
+                roundsHardware(abcd, previousA, e, messages, std::make_index_sequence<20>{});
+
+                e = _mm_sha1nexte_epu32(previousA, eSave);
+                abcd = _mm_add_epi32(abcd, abcdSave);
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), _mm_shuffle_epi32(abcd, 0x1B));
+            state[4] = static_cast<std::uint32_t>(_mm_extract_epi32(e, 3));
+        }
+#endif
+
+        inline void transformBlocks(const std::uint8_t* data,
+                                    const std::size_t blockCount,
+                                    State& state) noexcept
+        {
+#ifdef SHA1_X86
+            if (getCpuFeatures().sha)
+            {
+                transformBlocksHardware(data, blockCount, state);
+                return;
+            }
+#endif
+
+            for (std::size_t i = 0; i < blockCount; ++i)
+                transform(data + i * blockByteCount, state);
+        }
+    }
+
+    // incremental hashing of data that arrives in pieces, finalize returns the digest of all
+    // the data passed to update since the construction or the last finalize or reset
+    class Hasher final
+    {
+    public:
+        template <class Iterator>
+        void update(const Iterator begin, const Iterator end) noexcept
+        {
+            if constexpr (isContiguousByteIterator<Iterator>)
+            {
+                if (begin != end)
+                    update(reinterpret_cast<const std::uint8_t*>(std::addressof(*begin)),
+                           static_cast<std::size_t>(end - begin));
+            }
+            else
+            {
+                for (auto i = begin; i != end; ++i)
+                {
+                    block[dataSize % blockByteCount] = static_cast<std::uint8_t>(*i);
+                    if (++dataSize % blockByteCount == 0)
+                        transformBlocks(block.data(), 1, state);
+                }
+            }
+        }
+
+        // whole blocks are hashed straight from the data, only a partial block is copied to the buffer
+        void update(const std::uint8_t* data, std::size_t size) noexcept
+        {
+            const std::size_t offset = dataSize % blockByteCount;
+            dataSize += size;
+
+            if (offset != 0)
+            {
+                const std::size_t count = std::min(blockByteCount - offset, size);
+                std::copy(data, data + count, block.begin() + offset);
+                if (offset + count < blockByteCount) return;
+
+                transformBlocks(block.data(), 1, state);
+                data += count;
+                size -= count;
+            }
+
+            const std::size_t blockCount = size / blockByteCount;
+            transformBlocks(data, blockCount, state);
+            data += blockCount * blockByteCount;
+            std::copy(data, data + size % blockByteCount, block.begin());
+        }
+
+        template <class T>
+        void update(const T& v) noexcept
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            update(begin(v), end(v));
+        }
+
+        [[nodiscard]]
+        std::array<std::uint8_t, digestByteCount> finalize() noexcept
+        {
+            // pad data left in the buffer
+            const std::size_t n = dataSize % blockByteCount;
+            block[n] = 0x80;
+            if (n < blockByteCount - 8)
+            {
+                std::fill(block.begin() + n + 1, block.end() - 8, 0);
+            }
+            else
+            {
+                std::fill(block.begin() + n + 1, block.end(), 0);
+                transformBlocks(block.data(), 1, state);
+                std::fill(block.begin(), block.end() - 8, 0);
+            }
+
+            // append the size in bits
+            const std::uint64_t totalBits = dataSize * 8;
+            block[63] = static_cast<std::uint8_t>(totalBits);
+            block[62] = static_cast<std::uint8_t>(totalBits >> 8);
+            block[61] = static_cast<std::uint8_t>(totalBits >> 16);
+            block[60] = static_cast<std::uint8_t>(totalBits >> 24);
+            block[59] = static_cast<std::uint8_t>(totalBits >> 32);
+            block[58] = static_cast<std::uint8_t>(totalBits >> 40);
+            block[57] = static_cast<std::uint8_t>(totalBits >> 48);
+            block[56] = static_cast<std::uint8_t>(totalBits >> 56);
+            transformBlocks(block.data(), 1, state);
+
+            std::array<std::uint8_t, digestByteCount> result;
+            // reverse all the bytes to big endian
+            for (std::uint32_t i = 0; i < digestIntCount; ++i)
+            {
+                result[i * 4 + 0] = static_cast<std::uint8_t>(state[i] >> 24);
+                result[i * 4 + 1] = static_cast<std::uint8_t>(state[i] >> 16);
+                result[i * 4 + 2] = static_cast<std::uint8_t>(state[i] >> 8);
+                result[i * 4 + 3] = static_cast<std::uint8_t>(state[i]);
+            }
+
+            reset();
+            return result;
+        }
+
+        void reset() noexcept
+        {
+            state = initialState;
+            dataSize = 0;
+        }
+
+    private:
+        State state = initialState;
+        Block block{};
+        std::uint64_t dataSize = 0;
+    };
+
+    template <class Iterator>
+    [[nodiscard]]
+    std::array<std::uint8_t, digestByteCount> hash(const Iterator begin,
+                                                   const Iterator end) noexcept
+    {
+        Hasher hasher;
+        hasher.update(begin, end);
+        return hasher.finalize();
     }
 
     template <class T>
@@ -158,6 +388,23 @@ namespace sha1
         using std::begin, std::end; // add std::begin and std::end to lookup
         return hash(begin(v), end(v));
     }
+
+    // HMAC-SHA1 (RFC 2104 and RFC 2202)
+    using Hmac = hmac::BasicHmac<Hasher, blockByteCount, digestByteCount>;
+
+    template <class Data, class Key>
+    [[nodiscard]]
+    std::array<std::uint8_t, digestByteCount> generateHmac(const Data& data, const Key& key) noexcept
+    {
+        return Hmac{key}.generate(data);
+    }
+
+    template <class Data, class Key, class Tag>
+    [[nodiscard]]
+    bool verifyHmac(const Data& data, const Key& key, const Tag& tag) noexcept
+    {
+        return Hmac{key}.verify(data, tag);
+    }
 }
 
 #endif // SHA1_HPP
@@ -7,8 +7,33 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "hmac.hpp"
+#include "multibuffer.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define SHA2_X86
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  else
+#    include <cpuid.h>
+#    include <immintrin.h>
+#  endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define SHA2_TARGET(features) __attribute__((target(features)))
+#else
+#  define SHA2_TARGET(features)
+#endif
 
 namespace sha256
 {
@@ -47,7 +72,7 @@ namespace sha256
             return (value >> bits) | ((value & 0xFFFFFFFFU) << (32 - bits));
         }
 
-        inline void transform(const Block& block,
+        inline void transform(const std::uint8_t* block,
                               State& state) noexcept
         {
             std::array<std::uint32_t, 64> w;
@@ -102,14 +127,8 @@ namespace sha256
             state[6] += g;
             state[7] += h;
         }
-    }
 
-    template <class Iterator>
-    [[nodiscard]]
-    std::array<std::uint8_t, digestByteCount> hash(const Iterator begin,
-                                                   const Iterator end) noexcept
-    {
-        State state{
+        constexpr State initialState{
             0x6A09E667U,
             0xBB67AE85U,
             0x3C6EF372U,
@@ -120,52 +139,789 @@ namespace sha256
             0x5BE0CD19U
         };
 
-        Block block;
-        std::size_t dataSize = 0;
-        for (auto i = begin; i != end; ++i)
+        // the bytes of the iterators that point into contiguous memory can be hashed in place
+        template <class T>
+        constexpr bool isByte = sizeof(T) == 1 && !std::is_same_v<T, bool> &&
+            (std::is_integral_v<T> || std::is_same_v<T, std::byte>);
+
+        template <class Iterator, class Value = std::remove_cv_t<typename std::iterator_traits<Iterator>::value_type>>
+        constexpr bool isContiguousByteIterator = isByte<Value> &&
+            (std::is_pointer_v<Iterator> ||
+             std::is_same_v<Iterator, typename std::vector<Value>::iterator> ||
+             std::is_same_v<Iterator, typename std::vector<Value>::const_iterator> ||
+             std::is_same_v<Iterator, std::string::iterator> ||
+             std::is_same_v<Iterator, std::string::const_iterator>);
+
+#ifdef SHA2_X86
+        struct CpuFeatures final
+        {
+            bool sha = false;
+            bool avx2 = false;
+            bool avx512 = false;
+        };
+
+        [[nodiscard]] inline CpuFeatures detectCpuFeatures() noexcept
         {
-            block[dataSize % blockByteCount] = static_cast<std::uint8_t>(*i);
-            if (++dataSize % blockByteCount == 0)
-                transform(block, state);
+            CpuFeatures result;
+#  if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7) return result;
+            __cpuid(info, 1);
+            const auto ecx = static_cast<unsigned int>(info[2]);
+            __cpuidex(info, 7, 0);
+            const auto ebx = static_cast<unsigned int>(info[1]);
+#  else
+            unsigned int eax = 0;
+            unsigned int ebx = 0;
+            unsigned int ecx = 0;
+            unsigned int edx = 0;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+                return result;
+            const unsigned int leaf1Ecx = ecx;
+            if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+                return result;
+            ecx = leaf1Ecx;
+#  endif
+            const bool ssse3 = (ecx & (1U << 9)) != 0;
+            const bool sse41 = (ecx & (1U << 19)) != 0;
+            result.sha = ssse3 && sse41 && (ebx & (1U << 29)) != 0;
+
+            // the wide registers can only be used if the OS saves them on context switches
+            if ((ecx & (1U << 27)) == 0) return result; // OSXSAVE
+#  if defined(_MSC_VER)
+            const auto xcr0 = static_cast<std::uint64_t>(_xgetbv(0));
+#  else
+            unsigned int xcr0Low = 0;
+            unsigned int xcr0High = 0;
+            __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+            const std::uint64_t xcr0 = (static_cast<std::uint64_t>(xcr0High) << 32) | xcr0Low;
+#  endif
+            const bool avxState = (xcr0 & 0x06U) == 0x06U; // XMM and YMM
+            const bool avx512State = (xcr0 & 0xE6U) == 0xE6U; // and opmask and ZMM
+            result.avx2 = avxState && (ebx & (1U << 5)) != 0;
+            result.avx512 = avx512State && (ebx & (1U << 16)) != 0;
+            return result;
         }
 
-        // pad data left in the buffer
-        const std::size_t n = dataSize % blockByteCount;
-        block[n] = 0x80;
-        if (n < blockByteCount - 8)
+        [[nodiscard]] inline const CpuFeatures& getCpuFeatures() noexcept
         {
-            std::fill(block.begin() + n + 1, block.end() - 8, 0);
+            static const CpuFeatures cpuFeatures = detectCpuFeatures();
+            return cpuFeatures;
+        }
+
+        // Four rounds and one step of the message schedule. The round index is a template argument,
+        // as in sha1.hpp, so the message registers and the schedule step are fixed at compile time
+        // and the 16 groups of a block unroll into straight-line code.
+        template <std::size_t i>
+        SHA2_TARGET("sha,sse4.1,ssse3")
+        inline void roundsHardware(__m128i& abef, __m128i& cdgh, __m128i* messages) noexcept
+        {
+            if constexpr (i >= 4)
+            {
+                // w[t] = w[t - 16] + sigma0(w[t - 15]) + w[t - 7] + sigma1(w[t - 2])
+                const __m128i previous = messages[(i + 3) % 4];
+                const __m128i sum = _mm_add_epi32(_mm_sha256msg1_epu32(messages[i % 4], messages[(i + 1) % 4]),
+                                                  _mm_alignr_epi8(previous, messages[(i + 2) % 4], 4));
+                messages[i % 4] = _mm_sha256msg2_epu32(sum, previous);
+            }
+
+            const __m128i roundInput = _mm_add_epi32(messages[i % 4],
+                                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(&k[i * 4])));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, roundInput);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(roundInput, 0x0E));
         }
-        else
+
+        template <std::size_t... i>
+        SHA2_TARGET("sha,sse4.1,ssse3")
+        inline void roundsHardware(__m128i& abef, __m128i& cdgh, __m128i* messages, std::index_sequence<i...>) noexcept
         {
-            std::fill(block.begin() + n + 1, block.end(), 0);
-            transform(block, state);
-            std::fill(block.begin(), block.end() - 8, 0);
+            (roundsHardware<i>(abef, cdgh, messages), ...);
         }
 
-        // append the size in bits
-        const std::uint64_t totalBits = dataSize * 8;
-        block[63] = static_cast<std::uint8_t>(totalBits);
-        block[62] = static_cast<std::uint8_t>(totalBits >> 8);
-        block[61] = static_cast<std::uint8_t>(totalBits >> 16);
-        block[60] = static_cast<std::uint8_t>(totalBits >> 24);
-        block[59] = static_cast<std::uint8_t>(totalBits >> 32);
-        block[58] = static_cast<std::uint8_t>(totalBits >> 40);
-        block[57] = static_cast<std::uint8_t>(totalBits >> 48);
-        block[56] = static_cast<std::uint8_t>(totalBits >> 56);
-        transform(block, state);
+        // SHA extensions keep the state as ABEF and CDGH and run two rounds per sha256rnds2,
+        // the message schedule is four words per sha256msg1 and sha256msg2
+        SHA2_TARGET("sha,sse4.1,ssse3")
+        inline void transformBlocksHardware(const std::uint8_t* data,
+                                            const std::size_t blockCount,
+                                            State& state) noexcept
+        {
+            const __m128i byteSwapMask = _mm_set_epi64x(0x0C0D0E0F08090A0BLL, 0x0405060700010203LL);
+
+            const __m128i dcba = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0])), 0xB1);
+            const __m128i efgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4])), 0x1B);
+            __m128i abef = _mm_alignr_epi8(dcba, efgh, 8);
+            __m128i cdgh = _mm_blend_epi16(efgh, dcba, 0xF0);
+
+            for (std::size_t b = 0; b < blockCount; ++b, data += blockByteCount)
+            {
+                const __m128i abefSave = abef;
+                const __m128i cdghSave = cdgh;
+
+                __m128i messages[4] = {
+                    _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), byteSwapMask),
+                    _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)), byteSwapMask),
+                    _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)), byteSwapMask),
+                    _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)), byteSwapMask)
+                };
+
+                roundsHardware(abef, cdgh, messages, std::make_index_sequence<16>{});
 
-        std::array<std::uint8_t, digestByteCount> result;
-        // reverse all the bytes to big endian
-        for (std::uint32_t i = 0; i < digestIntCount; ++i)
+                abef = _mm_add_epi32(abef, abefSave);
+                cdgh = _mm_add_epi32(cdgh, cdghSave);
+            }
+
+            const __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+            const __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), _mm_blend_epi16(feba, dchg, 0xF0));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), _mm_alignr_epi8(dchg, feba, 8));
+        }
+#endif
+
+        inline void transformBlocks(const std::uint8_t* data,
+                                    const std::size_t blockCount,
+                                    State& state) noexcept
         {
-            result[i * 4 + 0] = static_cast<std::uint8_t>(state[i] >> 24);
-            result[i * 4 + 1] = static_cast<std::uint8_t>(state[i] >> 16);
-            result[i * 4 + 2] = static_cast<std::uint8_t>(state[i] >> 8);
-            result[i * 4 + 3] = static_cast<std::uint8_t>(state[i]);
+#ifdef SHA2_X86
+            if (getCpuFeatures().sha)
+            {
+                transformBlocksHardware(data, blockCount, state);
+                return;
+            }
+#endif
+
+            for (std::size_t i = 0; i < blockCount; ++i)
+                transform(data + i * blockByteCount, state);
         }
 
-        return result;
+        // a message hashed by hashBatch, the digest receives digestByteCount bytes
+        using Job = multibuffer::Job;
+
+        // The multi-buffer transforms hash one block of laneCount independent messages at a time,
+        // one message per vector lane. The state is stored word by word, laneCount lanes per word.
+        template <std::size_t laneCount>
+        using LaneState = std::array<std::uint32_t, digestIntCount * laneCount>;
+
+        template <std::size_t laneCount>
+        using LaneWords = std::array<std::uint32_t, blockIntCount * laneCount>;
+
+        template <std::size_t laneCount>
+        LaneWords<laneCount> loadLaneWords(const std::uint8_t* const* blocks) noexcept
+        {
+            return multibuffer::loadLaneWords<laneCount, multibuffer::ByteOrder::bigEndian>(blocks);
+        }
+
+#ifdef SHA2_X86
+        template <int bits>
+        SHA2_TARGET("avx2")
+        inline __m256i rotateRight(const __m256i value) noexcept
+        {
+            return _mm256_or_si256(_mm256_srli_epi32(value, bits), _mm256_slli_epi32(value, 32 - bits));
+        }
+
+        SHA2_TARGET("avx2")
+        inline void transformLanesAvx2(const std::uint8_t* const* blocks, LaneState<8>& state) noexcept
+        {
+            const LaneWords<8> words = loadLaneWords<8>(blocks);
+
+            __m256i v[digestIntCount];
+            for (std::size_t i = 0; i < digestIntCount; ++i)
+                v[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&state[i * 8]));
+
+            __m256i w[16];
+            for (std::size_t i = 0; i < 64; ++i)
+            {
+                if (i < 16)
+                    w[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&words[i * 8]));
+                else
+                {
+                    const __m256i w15 = w[(i - 15) % 16];
+                    const __m256i w2 = w[(i - 2) % 16];
+                    const __m256i sigma0 = _mm256_xor_si256(_mm256_xor_si256(rotateRight<7>(w15), rotateRight<18>(w15)),
+                                                            _mm256_srli_epi32(w15, 3));
+                    const __m256i sigma1 = _mm256_xor_si256(_mm256_xor_si256(rotateRight<17>(w2), rotateRight<19>(w2)),
+                                                            _mm256_srli_epi32(w2, 10));
+                    w[i % 16] = _mm256_add_epi32(_mm256_add_epi32(w[i % 16], sigma0),
+                                                 _mm256_add_epi32(w[(i - 7) % 16], sigma1));
+                }
+
+                const __m256i& a = v[(64 - i) % 8];
+                const __m256i& b = v[(65 - i) % 8];
+                const __m256i& c = v[(66 - i) % 8];
+                __m256i& d = v[(67 - i) % 8];
+                const __m256i& e = v[(68 - i) % 8];
+                const __m256i& f = v[(69 - i) % 8];
+                const __m256i& g = v[(70 - i) % 8];
+                __m256i& h = v[(71 - i) % 8];
+
+                const __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotateRight<6>(e), rotateRight<11>(e)), rotateRight<25>(e));
+                const __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+                const __m256i temp1 = _mm256_add_epi32(_mm256_add_epi32(h, s1),
+                                                       _mm256_add_epi32(_mm256_add_epi32(ch, w[i % 16]),
+                                                                        _mm256_set1_epi32(static_cast<int>(k[i]))));
+                const __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotateRight<2>(a), rotateRight<13>(a)), rotateRight<22>(a));
+                const __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+
+                // the registers are renamed instead of moved, h becomes the new a and d the new e
+                d = _mm256_add_epi32(d, temp1);
+                h = _mm256_add_epi32(temp1, _mm256_add_epi32(s0, maj));
+            }
+
+            for (std::size_t i = 0; i < digestIntCount; ++i)
+            {
+                const __m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&state[i * 8]));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(&state[i * 8]), _mm256_add_epi32(previous, v[i]));
+            }
+        }
+
+        // the masked forms with all the lanes set avoid the GCC 12 -Wmaybe-uninitialized false
+        // positive of the unmasked ones and compile to the same instructions
+        template <int bits>
+        SHA2_TARGET("avx512f")
+        inline __m512i rotateRight(const __m512i value) noexcept
+        {
+            return _mm512_maskz_ror_epi32(0xFFFF, value, bits);
+        }
+
+        template <int bits>
+        SHA2_TARGET("avx512f")
+        inline __m512i shiftRight(const __m512i value) noexcept
+        {
+            return _mm512_maskz_srli_epi32(0xFFFF, value, bits);
+        }
+
+        SHA2_TARGET("avx512f")
+        inline void transformLanesAvx512(const std::uint8_t* const* blocks, LaneState<16>& state) noexcept
+        {
+            const LaneWords<16> words = loadLaneWords<16>(blocks);
+
+            __m512i v[digestIntCount];
+            for (std::size_t i = 0; i < digestIntCount; ++i)
+                v[i] = _mm512_loadu_si512(&state[i * 16]);
+
+            __m512i w[16];
+            for (std::size_t i = 0; i < 64; ++i)
+            {
+                if (i < 16)
+                    w[i] = _mm512_loadu_si512(&words[i * 16]);
+                else
+                {
+                    const __m512i w15 = w[(i - 15) % 16];
+                    const __m512i w2 = w[(i - 2) % 16];
+                    const __m512i sigma0 = _mm512_ternarylogic_epi32(rotateRight<7>(w15), rotateRight<18>(w15),
+                                                                     shiftRight<3>(w15), 0x96);
+                    const __m512i sigma1 = _mm512_ternarylogic_epi32(rotateRight<17>(w2), rotateRight<19>(w2),
+                                                                     shiftRight<10>(w2), 0x96);
+                    w[i % 16] = _mm512_add_epi32(_mm512_add_epi32(w[i % 16], sigma0),
+                                                 _mm512_add_epi32(w[(i - 7) % 16], sigma1));
+                }
+
+                const __m512i& a = v[(64 - i) % 8];
+                const __m512i& b = v[(65 - i) % 8];
+                const __m512i& c = v[(66 - i) % 8];
+                __m512i& d = v[(67 - i) % 8];
+                const __m512i& e = v[(68 - i) % 8];
+                const __m512i& f = v[(69 - i) % 8];
+                const __m512i& g = v[(70 - i) % 8];
+                __m512i& h = v[(71 - i) % 8];
+
+                // 0x96 is a three-way xor, 0xCA picks f or g by e and 0xE8 is the majority
+                const __m512i s1 = _mm512_ternarylogic_epi32(rotateRight<6>(e), rotateRight<11>(e),
+                                                             rotateRight<25>(e), 0x96);
+                const __m512i ch = _mm512_ternarylogic_epi32(e, f, g, 0xCA);
+                const __m512i temp1 = _mm512_add_epi32(_mm512_add_epi32(h, s1),
+                                                       _mm512_add_epi32(_mm512_add_epi32(ch, w[i % 16]),
+                                                                        _mm512_set1_epi32(static_cast<int>(k[i]))));
+                const __m512i s0 = _mm512_ternarylogic_epi32(rotateRight<2>(a), rotateRight<13>(a),
+                                                             rotateRight<22>(a), 0x96);
+                const __m512i maj = _mm512_ternarylogic_epi32(a, b, c, 0xE8);
+
+                d = _mm512_add_epi32(d, temp1);
+                h = _mm512_add_epi32(temp1, _mm512_add_epi32(s0, maj));
+            }
+
+            for (std::size_t i = 0; i < digestIntCount; ++i)
+            {
+                const __m512i previous = _mm512_loadu_si512(&state[i * 16]);
+                _mm512_storeu_si512(&state[i * 16], _mm512_add_epi32(previous, v[i]));
+            }
+        }
+#endif
+
+        // the lane scheduler shared with md5.hpp, in multibuffer.hpp
+        template <std::size_t laneCount, class Transform>
+        void hashLanes(const Job* jobs, const std::size_t count, const Transform transform) noexcept
+        {
+            multibuffer::hashLanes<laneCount, multibuffer::ByteOrder::bigEndian>(jobs, count, initialState, transform);
+        }
+    }
+
+    // incremental hashing of data that arrives in pieces, finalize returns the digest of all
+    // the data passed to update since the construction or the last finalize or reset
+    class Hasher final
+    {
+    public:
+        template <class Iterator>
+        void update(const Iterator begin, const Iterator end) noexcept
+        {
+            if constexpr (isContiguousByteIterator<Iterator>)
+            {
+                if (begin != end)
+                    update(reinterpret_cast<const std::uint8_t*>(std::addressof(*begin)),
+                           static_cast<std::size_t>(end - begin));
+            }
+            else
+            {
+                for (auto i = begin; i != end; ++i)
+                {
+                    block[dataSize % blockByteCount] = static_cast<std::uint8_t>(*i);
+                    if (++dataSize % blockByteCount == 0)
+                        transformBlocks(block.data(), 1, state);
+                }
+            }
+        }
+
+        // whole blocks are hashed straight from the data, only a partial block is copied to the buffer
+        void update(const std::uint8_t* data, std::size_t size) noexcept
+        {
+            const std::size_t offset = dataSize % blockByteCount;
+            dataSize += size;
+
+            if (offset != 0)
+            {
+                const std::size_t count = std::min(blockByteCount - offset, size);
+                std::copy(data, data + count, block.begin() + offset);
+                if (offset + count < blockByteCount) return;
+
+                transformBlocks(block.data(), 1, state);
+                data += count;
+                size -= count;
+            }
+
+            const std::size_t blockCount = size / blockByteCount;
+            transformBlocks(data, blockCount, state);
+            data += blockCount * blockByteCount;
+            std::copy(data, data + size % blockByteCount, block.begin());
+        }
+
+        template <class T>
+        void update(const T& v) noexcept
+        {
+            using std::begin, std::end; // add std::begin and std::end to lookup
+            update(begin(v), end(v));
+        }
+
+        [[nodiscard]]
+        std::array<std::uint8_t, digestByteCount> finalize() noexcept
+        {
+            // pad data left in the buffer
+            const std::size_t n = dataSize % blockByteCount;
+            block[n] = 0x80;
+            if (n < blockByteCount - 8)
+            {
+                std::fill(block.begin() + n + 1, block.end() - 8, 0);
+            }
+            else
+            {
+                std::fill(block.begin() + n + 1, block.end(), 0);
+                transformBlocks(block.data(), 1, state);
+                std::fill(block.begin(), block.end() - 8, 0);
+            }
+
+            // append the size in bits
+            const std::uint64_t totalBits = dataSize * 8;
+            block[63] = static_cast<std::uint8_t>(totalBits);
+            block[62] = static_cast<std::uint8_t>(totalBits >> 8);
+            block[61] = static_cast<std::uint8_t>(totalBits >> 16);
+            block[60] = static_cast<std::uint8_t>(totalBits >> 24);
+            block[59] = static_cast<std::uint8_t>(totalBits >> 32);
+            block[58] = static_cast<std::uint8_t>(totalBits >> 40);
+            block[57] = static_cast<std::uint8_t>(totalBits >> 48);
+            block[56] = static_cast<std::uint8_t>(totalBits >> 56);
+            transformBlocks(block.data(), 1, state);
+
+            std::array<std::uint8_t, digestByteCount> result;
+            // reverse all the bytes to big endian
+            for (std::uint32_t i = 0; i < digestIntCount; ++i)
+            {
+                result[i * 4 + 0] = static_cast<std::uint8_t>(state[i] >> 24);
+                result[i * 4 + 1] = static_cast<std::uint8_t>(state[i] >> 16);
+                result[i * 4 + 2] = static_cast<std::uint8_t>(state[i] >> 8);
+                result[i * 4 + 3] = static_cast<std::uint8_t>(state[i]);
+            }
+
+            reset();
+            return result;
+        }
+
+        void reset() noexcept
+        {
+            state = initialState;
+            dataSize = 0;
+        }
+
+    private:
+        State state = initialState;
+        Block block{};
+        std::uint64_t dataSize = 0;
+    };
+
+    template <class Iterator>
+    [[nodiscard]]
+    std::array<std::uint8_t, digestByteCount> hash(const Iterator begin,
+                                                   const Iterator end) noexcept
+    {
+        Hasher hasher;
+        hasher.update(begin, end);
+        return hasher.finalize();
+    }
+
+    template <class T>
+    [[nodiscard]]
+    std::array<std::uint8_t, digestByteCount> hash(const T& v) noexcept
+    {
+        using std::begin, std::end; // add std::begin and std::end to lookup
+        return hash(begin(v), end(v));
+    }
+
+    // Hashes the independent messages of the jobs, 16 at a time in the vector lanes when the CPU
+    // has AVX-512, one at a time with the SHA extensions (which are as fast as 8 AVX2 lanes),
+    // 8 at a time with AVX2 and one at a time otherwise. Writes digestByteCount bytes to the
+    // digest of every job.
+    inline void hashBatch(const Job* jobs, const std::size_t count) noexcept
+    {
+#ifdef SHA2_X86
+        const CpuFeatures& cpuFeatures = getCpuFeatures();
+        if (cpuFeatures.avx512)
+        {
+            hashLanes<16>(jobs, count, transformLanesAvx512);
+            return;
+        }
+
+        if (cpuFeatures.avx2 && !cpuFeatures.sha)
+        {
+            hashLanes<8>(jobs, count, transformLanesAvx2);
+            return;
+        }
+#endif
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Hasher hasher;
+            hasher.update(jobs[i].data, jobs[i].size);
+            const auto digest = hasher.finalize();
+            std::copy(digest.begin(), digest.end(), jobs[i].digest);
+        }
+    }
+
+    // HMAC-SHA256 (RFC 4231)
+    using Hmac = hmac::BasicHmac<Hasher, blockByteCount, digestByteCount>;
+
+    template <class Data, class Key>
+    [[nodiscard]]
+    std::array<std::uint8_t, digestByteCount> generateHmac(const Data& data, const Key& key) noexcept
+    {
+        return Hmac{key}.generate(data);
+    }
+
+    template <class Data, class Key, class Tag>
+    [[nodiscard]]
+    bool verifyHmac(const Data& data, const Key& key, const Tag& tag) noexcept
+    {
+        return Hmac{key}.verify(data, tag);
+    }
+}
+
+namespace sha512
+{
+    inline namespace detail
+    {
+        constexpr std::array<std::uint64_t, 80> k{
+            0x428A2F98D728AE22U, 0x7137449123EF65CDU, 0xB5C0FBCFEC4D3B2FU, 0xE9B5DBA58189DBBCU,
+            0x3956C25BF348B538U, 0x59F111F1B605D019U, 0x923F82A4AF194F9BU, 0xAB1C5ED5DA6D8118U,
+            0xD807AA98A3030242U, 0x12835B0145706FBEU, 0x243185BE4EE4B28CU, 0x550C7DC3D5FFB4E2U,
+            0x72BE5D74F27B896FU, 0x80DEB1FE3B1696B1U, 0x9BDC06A725C71235U, 0xC19BF174CF692694U,
+            0xE49B69C19EF14AD2U, 0xEFBE4786384F25E3U, 0x0FC19DC68B8CD5B5U, 0x240CA1CC77AC9C65U,
+            0x2DE92C6F592B0275U, 0x4A7484AA6EA6E483U, 0x5CB0A9DCBD41FBD4U, 0x76F988DA831153B5U,
+            0x983E5152EE66DFABU, 0xA831C66D2DB43210U, 0xB00327C898FB213FU, 0xBF597FC7BEEF0EE4U,
+            0xC6E00BF33DA88FC2U, 0xD5A79147930AA725U, 0x06CA6351E003826FU, 0x142929670A0E6E70U,
+            0x27B70A8546D22FFCU, 0x2E1B21385C26C926U, 0x4D2C6DFC5AC42AEDU, 0x53380D139D95B3DFU,
+            0x650A73548BAF63DEU, 0x766A0ABB3C77B2A8U, 0x81C2C92E47EDAEE6U, 0x92722C851482353BU,
+            0xA2BFE8A14CF10364U, 0xA81A664BBC423001U, 0xC24B8B70D0F89791U, 0xC76C51A30654BE30U,
+            0xD192E819D6EF5218U, 0xD69906245565A910U, 0xF40E35855771202AU, 0x106AA07032BBD1B8U,
+            0x19A4C116B8D2D0C8U, 0x1E376C085141AB53U, 0x2748774CDF8EEB99U, 0x34B0BCB5E19B48A8U,
+            0x391C0CB3C5C95A63U, 0x4ED8AA4AE3418ACBU, 0x5B9CCA4F7763E373U, 0x682E6FF3D6B2B8A3U,
+            0x748F82EE5DEFB2FCU, 0x78A5636F43172F60U, 0x84C87814A1F0AB72U, 0x8CC702081A6439ECU,
+            0x90BEFFFA23631E28U, 0xA4506CEBDE82BDE9U, 0xBEF9A3F7B2C67915U, 0xC67178F2E372532BU,
+            0xCA273ECEEA26619CU, 0xD186B8C721C0C207U, 0xEADA7DD6CDE0EB1EU, 0xF57D4F7FEE6ED178U,
+            0x06F067AA72176FBAU, 0x0A637DC5A2C898A6U, 0x113F9804BEF90DAEU, 0x1B710B35131C471BU,
+            0x28DB77F523047D84U, 0x32CAAB7B40C72493U, 0x3C9EBE0A15C9BEBCU, 0x431D67C49C100D4CU,
+            0x4CC5D4BECB3E42B6U, 0x597F299CFC657E2AU, 0x5FCB6FAB3AD6FAECU, 0x6C44198C4A475817U
+        };
+
+        constexpr std::size_t digestIntCount = 8; // number of 64bit integers per SHA512 digest
+        constexpr std::size_t digestByteCount = digestIntCount * 8;
+        constexpr std::size_t blockIntCount = 16; // number of 64bit integers per SHA512 block
+        constexpr std::size_t blockByteCount = blockIntCount * 8;
+        using Block = std::array<std::uint8_t, blockByteCount>;
+        using State = std::array<std::uint64_t, digestIntCount>;
+
+        [[nodiscard]]
+        constexpr std::uint64_t rotateRight(const std::uint64_t value,
+                                            const std::uint64_t bits) noexcept
+        {
+            return (value >> bits) | (value << (64 - bits));
+        }
+
+        inline void transform(const std::uint8_t* block,
+                              State& state) noexcept
+        {
+            std::array<std::uint64_t, 80> w;
+            for (std::uint32_t i = 0; i < 16; ++i)
+            {
+                w[i] = 0;
+                for (std::uint32_t j = 0; j < 8; ++j)
+                    w[i] = (w[i] << 8) | static_cast<std::uint64_t>(block[i * 8 + j]);
+            }
+
+            for (std::uint32_t i = 16; i < 80; ++i)
+            {
+                const std::uint64_t sigma0 = rotateRight(w[i - 15], 1) ^ rotateRight(w[i - 15], 8) ^ (w[i - 15] >> 7);
+                const std::uint64_t sigma1 = rotateRight(w[i - 2], 19) ^ rotateRight(w[i - 2], 61) ^ (w[i - 2] >> 6);
+                w[i] = w[i - 16] + sigma0 + w[i - 7] + sigma1;
+            }
+
+            std::uint64_t a = state[0];
+            std::uint64_t b = state[1];
+            std::uint64_t c = state[2];
+            std::uint64_t d = state[3];
+            std::uint64_t e = state[4];
+            std::uint64_t f = state[5];
+            std::uint64_t g = state[6];
+            std::uint64_t h = state[7];
+
+            for (std::uint32_t i = 0; i < 80; ++i)
+            {
+                const std::uint64_t s1 = rotateRight(e, 14) ^ rotateRight(e, 18) ^ rotateRight(e, 41);
+                const std::uint64_t ch = (e & f) ^ (~e & g);
+                const std::uint64_t temp1 = h + s1 + ch + k[i] + w[i];
+
+                const std::uint64_t s0 = rotateRight(a, 28) ^ rotateRight(a, 34) ^ rotateRight(a, 39);
+                const std::uint64_t maj = (a & b) ^ (a & c) ^ (b & c);
+                const std::uint64_t temp2 = s0 + maj;
+
+                h = g;
+                g = f;
+                f = e;
+                e = d + temp1;
+                d = c;
+                c = b;
+                b = a;
+                a = temp1 + temp2;
+            }
+
+            state[0] += a;
+            state[1] += b;
+            state[2] += c;
+            state[3] += d;
+            state[4] += e;
+            state[5] += f;
+            state[6] += g;
+            state[7] += h;
+        }
+
+        inline void transformBlocks(const std::uint8_t* data,
+                                    const std::size_t blockCount,
+                                    State& state) noexcept
+        {
+            for (std::size_t i = 0; i < blockCount; ++i)
+                transform(data + i * blockByteCount, state);
+        }
+
+        constexpr State initialState{
+            0x6A09E667F3BCC908U, 0xBB67AE8584CAA73BU, 0x3C6EF372FE94F82BU, 0xA54FF53A5F1D36F1U,
+            0x510E527FADE682D1U, 0x9B05688C2B3E6C1FU, 0x1F83D9ABFB41BD6BU, 0x5BE0CD19137E2179U
+        };
+
+        using sha256::isContiguousByteIterator;
+
+        // SHA-384 and SHA-512/256 are SHA-512 with other initial values and the digest truncated
+        // to the first resultByteCount bytes
+        template <std::size_t resultByteCount, const State& startState>
+        class BasicHasher final
+        {
+        public:
+            template <class Iterator>
+            void update(const Iterator begin, const Iterator end) noexcept
+            {
+                if constexpr (isContiguousByteIterator<Iterator>)
+                {
+                    if (begin != end)
+                        update(reinterpret_cast<const std::uint8_t*>(std::addressof(*begin)),
+                               static_cast<std::size_t>(end - begin));
+                }
+                else
+                {
+                    for (auto i = begin; i != end; ++i)
+                    {
+                        block[dataSize % blockByteCount] = static_cast<std::uint8_t>(*i);
+                        if (++dataSize % blockByteCount == 0)
+                            transformBlocks(block.data(), 1, state);
+                    }
+                }
+            }
+
+            // whole blocks are hashed straight from the data, only a partial block is copied to the buffer
+            void update(const std::uint8_t* data, std::size_t size) noexcept
+            {
+                const std::size_t offset = dataSize % blockByteCount;
+                dataSize += size;
+
+                if (offset != 0)
+                {
+                    const std::size_t count = std::min(blockByteCount - offset, size);
+                    std::copy(data, data + count, block.begin() + offset);
+                    if (offset + count < blockByteCount) return;
+
+                    transformBlocks(block.data(), 1, state);
+                    data += count;
+                    size -= count;
+                }
+
+                const std::size_t blockCount = size / blockByteCount;
+                transformBlocks(data, blockCount, state);
+                data += blockCount * blockByteCount;
+                std::copy(data, data + size % blockByteCount, block.begin());
+            }
+
+            template <class T>
+            void update(const T& v) noexcept
+            {
+                using std::begin, std::end; // add std::begin and std::end to lookup
+                update(begin(v), end(v));
+            }
+
+            [[nodiscard]]
+            std::array<std::uint8_t, resultByteCount> finalize() noexcept
+            {
+                // pad data left in the buffer, the size takes the last 16 bytes
+                const std::size_t n = dataSize % blockByteCount;
+                block[n] = 0x80;
+                if (n < blockByteCount - 16)
+                {
+                    std::fill(block.begin() + n + 1, block.end() - 8, 0);
+                }
+                else
+                {
+                    std::fill(block.begin() + n + 1, block.end(), 0);
+                    transformBlocks(block.data(), 1, state);
+                    std::fill(block.begin(), block.end() - 8, 0);
+                }
+
+                // append the size in bits, the upper 64 bits stay zero
+                const std::uint64_t totalBits = dataSize * 8;
+                for (std::size_t i = 0; i < 8; ++i)
+                    block[blockByteCount - 1 - i] = static_cast<std::uint8_t>(totalBits >> (i * 8));
+                transformBlocks(block.data(), 1, state);
+
+                std::array<std::uint8_t, resultByteCount> result;
+                // reverse all the bytes to big endian
+                for (std::size_t i = 0; i < resultByteCount; ++i)
+                    result[i] = static_cast<std::uint8_t>(state[i / 8] >> (56 - (i % 8) * 8));
+
+                reset();
+                return result;
+            }
+
+            void reset() noexcept
+            {
+                state = startState;
+                dataSize = 0;
+            }
+
+        private:
+            State state = startState;
+            Block block{};
+            std::uint64_t dataSize = 0;
+        };
+    }
+
+    using Hasher = BasicHasher<digestByteCount, initialState>;
+
+    template <class Iterator>
+    [[nodiscard]]
+    std::array<std::uint8_t, digestByteCount> hash(const Iterator begin,
+                                                   const Iterator end) noexcept
+    {
+        Hasher hasher;
+        hasher.update(begin, end);
+        return hasher.finalize();
+    }
+
+    template <class T>
+    [[nodiscard]]
+    std::array<std::uint8_t, digestByteCount> hash(const T& v) noexcept
+    {
+        using std::begin, std::end; // add std::begin and std::end to lookup
+        return hash(begin(v), end(v));
+    }
+}
+
+namespace sha384
+{
+    inline namespace detail
+    {
+        constexpr std::size_t digestByteCount = 48;
+
+        constexpr sha512::State initialState{
+            0xCBBB9D5DC1059ED8U, 0x629A292A367CD507U, 0x9159015A3070DD17U, 0x152FECD8F70E5939U,
+            0x67332667FFC00B31U, 0x8EB44A8768581511U, 0xDB0C2E0D64F98FA7U, 0x47B5481DBEFA4FA4U
+        };
+    }
+
+    using Hasher = sha512::BasicHasher<digestByteCount, initialState>;
+
+    template <class Iterator>
+    [[nodiscard]]
+    std::array<std::uint8_t, digestByteCount> hash(const Iterator begin,
+                                                   const Iterator end) noexcept
+    {
+        Hasher hasher;
+        hasher.update(begin, end);
+        return hasher.finalize();
+    }
+
+    template <class T>
+    [[nodiscard]]
+    std::array<std::uint8_t, digestByteCount> hash(const T& v) noexcept
+    {
+        using std::begin, std::end; // add std::begin and std::end to lookup
+        return hash(begin(v), end(v));
+    }
+}
+
+namespace sha512_256
+{
+    inline namespace detail
+    {
+        constexpr std::size_t digestByteCount = 32;
+
+        constexpr sha512::State initialState{
+            0x22312194FC2BF72CU, 0x9F555FA3C84C64C2U, 0x2393B86B6F53B151U, 0x963877195940EABDU,
+            0x96283EE2A88EFFE3U, 0xBE5E1E2553863992U, 0x2B0199FC2C85B8AAU, 0x0EB72DDC81C52CA2U
+        };
+    }
+
+    using Hasher = sha512::BasicHasher<digestByteCount, initialState>;
+
+    template <class Iterator>
+    [[nodiscard]]
+    std::array<std::uint8_t, digestByteCount> hash(const Iterator begin,
+                                                   const Iterator end) noexcept
+    {
+        Hasher hasher;
+        hasher.update(begin, end);
+        return hasher.finalize();
     }
 
     template <class T>
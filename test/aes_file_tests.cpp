@@ -0,0 +1,125 @@
+// aes_file.hpp maps the files with POSIX mmap, so these tests are not built on Windows
+#if !defined(_WIN32)
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "catch2/catch.hpp"
+#include "aes_file.hpp"
+
+namespace
+{
+    void writeFile(const std::string& path, const std::vector<std::uint8_t>& data)
+    {
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    std::vector<std::uint8_t> readFile(const std::string& path)
+    {
+        std::vector<std::uint8_t> result(static_cast<std::size_t>(std::filesystem::file_size(path)));
+        std::ifstream file{path, std::ios::binary};
+        file.read(reinterpret_cast<char*>(result.data()), static_cast<std::streamsize>(result.size()));
+        return result;
+    }
+
+    template <aes::Mode mode>
+    void testFiles(const std::vector<std::uint8_t>& data, const std::size_t threadCount)
+    {
+        constexpr std::array<std::uint8_t, 32> key{
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+            0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+            0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F
+        };
+
+        constexpr std::array<std::uint8_t, 16> initVector{
+            0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF
+        };
+
+        const aes::Cipher<256> cipher{key};
+        std::vector<std::uint8_t> encrypted;
+        std::vector<std::uint8_t> decrypted;
+        if constexpr (mode == aes::Mode::ecb)
+        {
+            encrypted = cipher.encryptEcb(data);
+            decrypted = cipher.decryptEcb(encrypted);
+        }
+        else if constexpr (mode == aes::Mode::cbc)
+        {
+            encrypted = cipher.encryptCbc(data, initVector);
+            decrypted = cipher.decryptCbc(encrypted, initVector);
+        }
+        else if constexpr (mode == aes::Mode::cfb)
+        {
+            encrypted = cipher.encryptCfb(data, initVector);
+            decrypted = cipher.decryptCfb(encrypted, initVector);
+        }
+        else if constexpr (mode == aes::Mode::ctr)
+        {
+            encrypted = cipher.encryptCtr(data, initVector);
+            decrypted = cipher.decryptCtr(encrypted, initVector);
+        }
+
+        const auto directory = std::filesystem::temp_directory_path();
+        const std::string inputPath = (directory / "hlibs_aes_file_input").string();
+        const std::string outputPath = (directory / "hlibs_aes_file_output").string();
+
+        writeFile(inputPath, data);
+        aes::encryptFile<256, mode>(inputPath, outputPath, key, initVector, threadCount);
+        REQUIRE(readFile(outputPath) == encrypted);
+
+        aes::decryptFile<256, mode>(outputPath, inputPath, key, initVector, threadCount);
+        REQUIRE(readFile(inputPath) == decrypted);
+
+        writeFile(inputPath, data);
+        aes::encryptFileInPlace<256, mode>(inputPath, key, initVector, threadCount);
+        REQUIRE(readFile(inputPath) == encrypted);
+
+        aes::decryptFileInPlace<256, mode>(inputPath, key, initVector, threadCount);
+        REQUIRE(readFile(inputPath) == decrypted);
+
+        std::filesystem::remove(inputPath);
+        std::filesystem::remove(outputPath);
+    }
+}
+
+TEST_CASE("AES file", "[aes]")
+{
+    SECTION("Small")
+    {
+        for (const std::size_t size : {0, 1, 16, 100})
+        {
+            std::vector<std::uint8_t> data(size);
+            for (std::size_t i = 0; i < data.size(); ++i)
+                data[i] = static_cast<std::uint8_t>(i * 13);
+
+            testFiles<aes::Mode::ecb>(data, 1);
+            testFiles<aes::Mode::cbc>(data, 1);
+            testFiles<aes::Mode::cfb>(data, 1);
+            testFiles<aes::Mode::ctr>(data, 1);
+        }
+    }
+
+    SECTION("Windows")
+    {
+        // two windows with a partial last block, so the chaining carries from one window to the next
+        std::vector<std::uint8_t> data(aes::fileChunkSize + 37);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<std::uint8_t>(i * 7 + (i >> 12));
+
+        testFiles<aes::Mode::cbc>(data, 3);
+        testFiles<aes::Mode::ctr>(data, 3);
+    }
+
+    SECTION("Errors")
+    {
+        const std::array<std::uint8_t, 16> key{};
+        REQUIRE_THROWS_AS((aes::encryptFileInPlace<128, aes::Mode::ecb>("/nonexistent/hlibs_aes_file", key)), aes::FileError);
+    }
+}
+
+#endif
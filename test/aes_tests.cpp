@@ -1,9 +1,46 @@
 #include <cstddef>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 #include "catch2/catch.hpp"
 #include "aes.hpp"
 
+namespace
+{
+    // std::array comparison is not constexpr before C++20
+    template <class T, std::size_t size>
+    constexpr bool isEqual(const std::array<T, size>& first, const std::array<T, size>& second) noexcept
+    {
+        for (std::size_t i = 0; i < size; ++i)
+            if (first[i] != second[i]) return false;
+        return true;
+    }
+
+    template <std::size_t keyLength>
+    void testBackend(const aes::Backend backend,
+                     const std::vector<std::uint8_t>& key,
+                     const std::vector<std::uint8_t>& result)
+    {
+        const std::vector<std::uint8_t> data{
+            0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+            0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF
+        };
+
+        const aes::Cipher<keyLength> cipher{key, backend};
+        REQUIRE(cipher.getBackend() == backend);
+
+        const auto e = cipher.encryptEcb(data);
+        REQUIRE(e == result);
+
+        const auto d = cipher.decryptEcb(e);
+        REQUIRE(d == data);
+    }
+}
+
 TEST_CASE("AES", "[aes]")
 {
     constexpr std::array<std::uint8_t, 32> key{
@@ -85,6 +122,760 @@ TEST_CASE("AES", "[aes]")
         }
     }
 
+    SECTION("Parallel decryption")
+    {
+        std::vector<std::uint8_t> data(1024 * 1024 + 7);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<std::uint8_t>(i * 31);
+
+        for (const auto backend : {aes::Backend::reference, aes::Backend::table, aes::Backend::hardware, aes::Backend::bitsliced})
+        {
+            if (!aes::isSupported(backend)) continue;
+
+            aes::Cipher<256> cipher{key, backend};
+            const auto cbc = cipher.encryptCbc(data, initVector);
+            const auto cfb = cipher.encryptCfb(data, initVector);
+            const auto cbcDecrypted = cipher.decryptCbc(cbc, initVector);
+            const auto cfbDecrypted = cipher.decryptCfb(cfb, initVector);
+            REQUIRE(std::equal(data.begin(), data.end(), cbcDecrypted.begin()));
+            REQUIRE(std::equal(data.begin(), data.end(), cfbDecrypted.begin()));
+
+            for (const std::size_t threadCount : {std::size_t{3}, std::size_t{4}})
+            {
+                cipher.setThreadCount(threadCount);
+                REQUIRE(cipher.decryptCbc(cbc, initVector) == cbcDecrypted);
+                REQUIRE(cipher.decryptCfb(cfb, initVector) == cfbDecrypted);
+
+                // the chunks must not read ciphertext already overwritten by the previous chunk
+                auto inPlace = cbc;
+                cipher.decryptCbc(inPlace.data(), inPlace.size(), inPlace.data(), initVector);
+                REQUIRE(inPlace == cbcDecrypted);
+
+                inPlace = cfb;
+                cipher.decryptCfb(inPlace.data(), inPlace.size(), inPlace.data(), initVector);
+                REQUIRE(inPlace == cfbDecrypted);
+            }
+        }
+    }
+
+    SECTION("CTR")
+    {
+        // NIST SP 800-38A F.5.5
+        const std::vector<std::uint8_t> keyCtr{
+            0x60, 0x3D, 0xEB, 0x10, 0x15, 0xCA, 0x71, 0xBE, 0x2B, 0x73, 0xAE, 0xF0, 0x85, 0x7D, 0x77, 0x81,
+            0x1F, 0x35, 0x2C, 0x07, 0x3B, 0x61, 0x08, 0xD7, 0x2D, 0x98, 0x10, 0xA3, 0x09, 0x14, 0xDF, 0xF4
+        };
+
+        const std::vector<std::uint8_t> initVectorCtr{
+            0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF
+        };
+
+        const std::vector<std::uint8_t> initVectorCarry{
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+        };
+
+        const struct final
+        {
+            std::vector<std::uint8_t> key;
+            std::vector<std::uint8_t> initVector;
+            std::vector<std::uint8_t> data;
+            std::vector<std::uint8_t> result;
+        } testCasesCtr[] = {
+            {keyCtr, initVectorCtr, {}, {}},
+            {keyCtr, initVectorCtr, {
+                0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+                0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C, 0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+                0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11, 0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+                0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17, 0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10
+            }, {
+                0x60, 0x1E, 0xC3, 0x13, 0x77, 0x57, 0x89, 0xA5, 0xB7, 0xA7, 0xF5, 0x04, 0xBB, 0xF3, 0xD2, 0x28,
+                0xF4, 0x43, 0xE3, 0xCA, 0x4D, 0x62, 0xB5, 0x9A, 0xCA, 0x84, 0xE9, 0x90, 0xCA, 0xCA, 0xF5, 0xC5,
+                0x2B, 0x09, 0x30, 0xDA, 0xA2, 0x3D, 0xE9, 0x4C, 0xE8, 0x70, 0x17, 0xBA, 0x2D, 0x84, 0x98, 0x8D,
+                0xDF, 0xC9, 0xC5, 0x8D, 0xB6, 0x7A, 0xAD, 0xA6, 0x13, 0xC2, 0xDD, 0x08, 0x45, 0x79, 0x41, 0xA6
+            }},
+            {{key.begin(), key.end()}, initVectorCarry, std::vector<std::uint8_t>(40), {
+                0xA6, 0xFB, 0xDB, 0x5C, 0xFD, 0xE0, 0x7D, 0x1B, 0x58, 0xFD, 0x36, 0x21, 0x77, 0xBC, 0xFF, 0xDF,
+                0x51, 0x1D, 0xD5, 0xEF, 0x9A, 0x68, 0x2B, 0x7D, 0xA4, 0x9F, 0x91, 0xC8, 0x6C, 0x4F, 0x7A, 0xC3,
+                0x40, 0xC5, 0x3C, 0xEF, 0x92, 0xEF, 0x2D, 0x64
+            }}
+        };
+
+        for (const auto& testCase : testCasesCtr)
+        {
+            const auto e = aes::encryptCtr<256>(testCase.data, testCase.key, testCase.initVector);
+            REQUIRE(e == testCase.result);
+
+            const auto d = aes::decryptCtr<256>(e, testCase.key, testCase.initVector);
+            REQUIRE(d == testCase.data);
+        }
+
+        std::vector<std::uint8_t> data(1024 * 1024 + 7);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<std::uint8_t>(i * 31);
+
+        for (const auto backend : {aes::Backend::reference, aes::Backend::table, aes::Backend::hardware, aes::Backend::bitsliced})
+        {
+            if (!aes::isSupported(backend)) continue;
+
+            aes::Cipher<256> cipher{key, backend};
+            const auto e = cipher.encryptCtr(data, initVector);
+            REQUIRE(e.size() == data.size());
+
+            cipher.setThreadCount(4);
+            REQUIRE(cipher.encryptCtr(data, initVector) == e);
+
+            cipher.setThreadCount(3);
+            REQUIRE(cipher.decryptCtr(e, initVector) == data);
+        }
+    }
+
+    SECTION("GCM")
+    {
+        // test cases 13-16 and 18 from the GCM specification
+        const struct final
+        {
+            std::vector<std::uint8_t> key;
+            std::vector<std::uint8_t> initVector;
+            std::vector<std::uint8_t> data;
+            std::vector<std::uint8_t> additionalData;
+            std::vector<std::uint8_t> result;
+        } testCasesGcm[] = {
+            {{
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+            }, {
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+            }, {}, {}, {
+                0x53, 0x0F, 0x8A, 0xFB, 0xC7, 0x45, 0x36, 0xB9, 0xA9, 0x63, 0xB4, 0xF1, 0xC4, 0xCB, 0x73, 0x8B
+            }},
+            {{
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+            }, {
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+            }, {
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+            }, {}, {
+                0xCE, 0xA7, 0x40, 0x3D, 0x4D, 0x60, 0x6B, 0x6E, 0x07, 0x4E, 0xC5, 0xD3, 0xBA, 0xF3, 0x9D, 0x18,
+                0xD0, 0xD1, 0xC8, 0xA7, 0x99, 0x99, 0x6B, 0xF0, 0x26, 0x5B, 0x98, 0xB5, 0xD4, 0x8A, 0xB9, 0x19
+            }},
+            {{
+                0xFE, 0xFF, 0xE9, 0x92, 0x86, 0x65, 0x73, 0x1C, 0x6D, 0x6A, 0x8F, 0x94, 0x67, 0x30, 0x83, 0x08,
+                0xFE, 0xFF, 0xE9, 0x92, 0x86, 0x65, 0x73, 0x1C, 0x6D, 0x6A, 0x8F, 0x94, 0x67, 0x30, 0x83, 0x08
+            }, {
+                0xCA, 0xFE, 0xBA, 0xBE, 0xFA, 0xCE, 0xDB, 0xAD, 0xDE, 0xCA, 0xF8, 0x88
+            }, {
+                0xD9, 0x31, 0x32, 0x25, 0xF8, 0x84, 0x06, 0xE5, 0xA5, 0x59, 0x09, 0xC5, 0xAF, 0xF5, 0x26, 0x9A,
+                0x86, 0xA7, 0xA9, 0x53, 0x15, 0x34, 0xF7, 0xDA, 0x2E, 0x4C, 0x30, 0x3D, 0x8A, 0x31, 0x8A, 0x72,
+                0x1C, 0x3C, 0x0C, 0x95, 0x95, 0x68, 0x09, 0x53, 0x2F, 0xCF, 0x0E, 0x24, 0x49, 0xA6, 0xB5, 0x25,
+                0xB1, 0x6A, 0xED, 0xF5, 0xAA, 0x0D, 0xE6, 0x57, 0xBA, 0x63, 0x7B, 0x39, 0x1A, 0xAF, 0xD2, 0x55
+            }, {}, {
+                0x52, 0x2D, 0xC1, 0xF0, 0x99, 0x56, 0x7D, 0x07, 0xF4, 0x7F, 0x37, 0xA3, 0x2A, 0x84, 0x42, 0x7D,
+                0x64, 0x3A, 0x8C, 0xDC, 0xBF, 0xE5, 0xC0, 0xC9, 0x75, 0x98, 0xA2, 0xBD, 0x25, 0x55, 0xD1, 0xAA,
+                0x8C, 0xB0, 0x8E, 0x48, 0x59, 0x0D, 0xBB, 0x3D, 0xA7, 0xB0, 0x8B, 0x10, 0x56, 0x82, 0x88, 0x38,
+                0xC5, 0xF6, 0x1E, 0x63, 0x93, 0xBA, 0x7A, 0x0A, 0xBC, 0xC9, 0xF6, 0x62, 0x89, 0x80, 0x15, 0xAD,
+                0xB0, 0x94, 0xDA, 0xC5, 0xD9, 0x34, 0x71, 0xBD, 0xEC, 0x1A, 0x50, 0x22, 0x70, 0xE3, 0xCC, 0x6C
+            }},
+            {{
+                0xFE, 0xFF, 0xE9, 0x92, 0x86, 0x65, 0x73, 0x1C, 0x6D, 0x6A, 0x8F, 0x94, 0x67, 0x30, 0x83, 0x08,
+                0xFE, 0xFF, 0xE9, 0x92, 0x86, 0x65, 0x73, 0x1C, 0x6D, 0x6A, 0x8F, 0x94, 0x67, 0x30, 0x83, 0x08
+            }, {
+                0xCA, 0xFE, 0xBA, 0xBE, 0xFA, 0xCE, 0xDB, 0xAD, 0xDE, 0xCA, 0xF8, 0x88
+            }, {
+                0xD9, 0x31, 0x32, 0x25, 0xF8, 0x84, 0x06, 0xE5, 0xA5, 0x59, 0x09, 0xC5, 0xAF, 0xF5, 0x26, 0x9A,
+                0x86, 0xA7, 0xA9, 0x53, 0x15, 0x34, 0xF7, 0xDA, 0x2E, 0x4C, 0x30, 0x3D, 0x8A, 0x31, 0x8A, 0x72,
+                0x1C, 0x3C, 0x0C, 0x95, 0x95, 0x68, 0x09, 0x53, 0x2F, 0xCF, 0x0E, 0x24, 0x49, 0xA6, 0xB5, 0x25,
+                0xB1, 0x6A, 0xED, 0xF5, 0xAA, 0x0D, 0xE6, 0x57, 0xBA, 0x63, 0x7B, 0x39
+            }, {
+                0xFE, 0xED, 0xFA, 0xCE, 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED, 0xFA, 0xCE, 0xDE, 0xAD, 0xBE, 0xEF,
+                0xAB, 0xAD, 0xDA, 0xD2
+            }, {
+                0x52, 0x2D, 0xC1, 0xF0, 0x99, 0x56, 0x7D, 0x07, 0xF4, 0x7F, 0x37, 0xA3, 0x2A, 0x84, 0x42, 0x7D,
+                0x64, 0x3A, 0x8C, 0xDC, 0xBF, 0xE5, 0xC0, 0xC9, 0x75, 0x98, 0xA2, 0xBD, 0x25, 0x55, 0xD1, 0xAA,
+                0x8C, 0xB0, 0x8E, 0x48, 0x59, 0x0D, 0xBB, 0x3D, 0xA7, 0xB0, 0x8B, 0x10, 0x56, 0x82, 0x88, 0x38,
+                0xC5, 0xF6, 0x1E, 0x63, 0x93, 0xBA, 0x7A, 0x0A, 0xBC, 0xC9, 0xF6, 0x62, 0x76, 0xFC, 0x6E, 0xCE,
+                0x0F, 0x4E, 0x17, 0x68, 0xCD, 0xDF, 0x88, 0x53, 0xBB, 0x2D, 0x55, 0x1B
+            }},
+            {{
+                0xFE, 0xFF, 0xE9, 0x92, 0x86, 0x65, 0x73, 0x1C, 0x6D, 0x6A, 0x8F, 0x94, 0x67, 0x30, 0x83, 0x08,
+                0xFE, 0xFF, 0xE9, 0x92, 0x86, 0x65, 0x73, 0x1C, 0x6D, 0x6A, 0x8F, 0x94, 0x67, 0x30, 0x83, 0x08
+            }, {
+                0x93, 0x13, 0x22, 0x5D, 0xF8, 0x84, 0x06, 0xE5, 0x55, 0x90, 0x9C, 0x5A, 0xFF, 0x52, 0x69, 0xAA,
+                0x6A, 0x7A, 0x95, 0x38, 0x53, 0x4F, 0x7D, 0xA1, 0xE4, 0xC3, 0x03, 0xD2, 0xA3, 0x18, 0xA7, 0x28,
+                0xC3, 0xC0, 0xC9, 0x51, 0x56, 0x80, 0x95, 0x39, 0xFC, 0xF0, 0xE2, 0x42, 0x9A, 0x6B, 0x52, 0x54,
+                0x16, 0xAE, 0xDB, 0xF5, 0xA0, 0xDE, 0x6A, 0x57, 0xA6, 0x37, 0xB3, 0x9B
+            }, {
+                0xD9, 0x31, 0x32, 0x25, 0xF8, 0x84, 0x06, 0xE5, 0xA5, 0x59, 0x09, 0xC5, 0xAF, 0xF5, 0x26, 0x9A,
+                0x86, 0xA7, 0xA9, 0x53, 0x15, 0x34, 0xF7, 0xDA, 0x2E, 0x4C, 0x30, 0x3D, 0x8A, 0x31, 0x8A, 0x72,
+                0x1C, 0x3C, 0x0C, 0x95, 0x95, 0x68, 0x09, 0x53, 0x2F, 0xCF, 0x0E, 0x24, 0x49, 0xA6, 0xB5, 0x25,
+                0xB1, 0x6A, 0xED, 0xF5, 0xAA, 0x0D, 0xE6, 0x57, 0xBA, 0x63, 0x7B, 0x39
+            }, {
+                0xFE, 0xED, 0xFA, 0xCE, 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED, 0xFA, 0xCE, 0xDE, 0xAD, 0xBE, 0xEF,
+                0xAB, 0xAD, 0xDA, 0xD2
+            }, {
+                0x5A, 0x8D, 0xEF, 0x2F, 0x0C, 0x9E, 0x53, 0xF1, 0xF7, 0x5D, 0x78, 0x53, 0x65, 0x9E, 0x2A, 0x20,
+                0xEE, 0xB2, 0xB2, 0x2A, 0xAF, 0xDE, 0x64, 0x19, 0xA0, 0x58, 0xAB, 0x4F, 0x6F, 0x74, 0x6B, 0xF4,
+                0x0F, 0xC0, 0xC3, 0xB7, 0x80, 0xF2, 0x44, 0x45, 0x2D, 0xA3, 0xEB, 0xF1, 0xC5, 0xD8, 0x2C, 0xDE,
+                0xA2, 0x41, 0x89, 0x97, 0x20, 0x0E, 0xF8, 0x2E, 0x44, 0xAE, 0x7E, 0x3F, 0xA4, 0x4A, 0x82, 0x66,
+                0xEE, 0x1C, 0x8E, 0xB0, 0xC8, 0xB5, 0xD4, 0xCF, 0x5A, 0xE9, 0xF1, 0x9A
+            }}
+        };
+
+        for (const auto backend : {aes::Backend::reference, aes::Backend::table, aes::Backend::hardware, aes::Backend::bitsliced})
+        {
+            if (!aes::isSupported(backend)) continue;
+
+            for (const auto& testCase : testCasesGcm)
+            {
+                const aes::Cipher<256> cipher{testCase.key, backend};
+
+                const auto e = cipher.encryptGcm(testCase.data, testCase.initVector, testCase.additionalData);
+                REQUIRE(e == testCase.result);
+
+                const auto d = cipher.decryptGcm(e, testCase.initVector, testCase.additionalData);
+                REQUIRE(d == testCase.data);
+
+                auto tampered = e;
+                tampered.back() ^= 0x01;
+                REQUIRE_THROWS_AS(cipher.decryptGcm(tampered, testCase.initVector, testCase.additionalData), aes::AuthenticationError);
+            }
+        }
+
+        std::vector<std::uint8_t> data(1000);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<std::uint8_t>(i * 7);
+
+        const auto e = aes::encryptGcm<256>(data, key, initVector, data);
+        REQUIRE(aes::Cipher<256>(key, aes::Backend::table).encryptGcm(data, initVector, data) == e);
+        REQUIRE(aes::decryptGcm<256>(e, key, initVector, data) == data);
+        REQUIRE(aes::decryptGcm<256>(aes::encryptGcm<256>(data, key, initVector), key, initVector) == data);
+        REQUIRE_THROWS_AS(aes::decryptGcm<256>(std::vector<std::uint8_t>(15), key, initVector), aes::AuthenticationError);
+        REQUIRE_THROWS_AS(aes::encryptGcm<256>(data, key, std::vector<std::uint8_t>{}), aes::DataSizeError);
+        REQUIRE_THROWS_AS(aes::decryptGcm<256>(e, key, std::vector<std::uint8_t>{}), aes::DataSizeError);
+
+        // the size is checked before the data is accessed
+        if constexpr (sizeof(std::size_t) > 4)
+        {
+            const aes::Cipher<256> cipher{key};
+            const std::array<std::uint8_t, 0> noData{};
+            const auto tooLong = static_cast<std::size_t>(aes::gcmMaxDataByteCount + 1);
+            REQUIRE_THROWS_AS(cipher.encryptGcm(nullptr, tooLong, nullptr, initVector, noData), aes::DataSizeError);
+            REQUIRE_THROWS_AS(cipher.decryptGcm(nullptr, tooLong + aes::tagByteCount, nullptr, initVector, noData), aes::DataSizeError);
+        }
+    }
+
+    SECTION("CMAC")
+    {
+        // RFC 4493 section 4
+        const std::vector<std::uint8_t> keyCmac{
+            0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+        };
+
+        const std::vector<std::uint8_t> message{
+            0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+            0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C, 0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+            0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11, 0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+            0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17, 0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10
+        };
+
+        const struct final
+        {
+            std::size_t size;
+            std::array<std::uint8_t, 16> tag;
+        } testCases[] = {
+            {0, {0xBB, 0x1D, 0x69, 0x29, 0xE9, 0x59, 0x37, 0x28, 0x7F, 0xA3, 0x7D, 0x12, 0x9B, 0x75, 0x67, 0x46}},
+            {16, {0x07, 0x0A, 0x16, 0xB4, 0x6B, 0x4D, 0x41, 0x44, 0xF7, 0x9B, 0xDD, 0x9D, 0xD0, 0x4A, 0x28, 0x7C}},
+            {40, {0xDF, 0xA6, 0x67, 0x47, 0xDE, 0x9A, 0xE6, 0x30, 0x30, 0xCA, 0x32, 0x61, 0x14, 0x97, 0xC8, 0x27}},
+            {64, {0x51, 0xF0, 0xBE, 0xBF, 0x7E, 0x3B, 0x9D, 0x92, 0xFC, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3C, 0xFE}}
+        };
+
+        for (const auto& testCase : testCases)
+        {
+            const std::vector<std::uint8_t> data(message.begin(), message.begin() + static_cast<std::ptrdiff_t>(testCase.size));
+            REQUIRE(aes::generateCmac<128>(data, keyCmac) == testCase.tag);
+            REQUIRE(aes::verifyCmac<128>(data, keyCmac, testCase.tag));
+
+            auto wrongTag = testCase.tag;
+            wrongTag[15] ^= 0x01;
+            REQUIRE_FALSE(aes::verifyCmac<128>(data, keyCmac, wrongTag));
+            REQUIRE_FALSE(aes::verifyCmac<128>(data, keyCmac, std::vector<std::uint8_t>(testCase.tag.begin(), testCase.tag.end() - 1)));
+        }
+
+        // generated with OpenSSL, data i * 7
+        std::vector<std::uint8_t> data(100);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<std::uint8_t>(i * 7);
+
+        const std::array<std::uint8_t, 16> tag{
+            0x09, 0xC9, 0xB0, 0xBB, 0xD6, 0x96, 0x28, 0x41, 0xE5, 0x0D, 0x09, 0x4B, 0x2A, 0x1E, 0xA8, 0x41
+        };
+
+        for (const auto backend : {aes::Backend::reference, aes::Backend::table, aes::Backend::hardware, aes::Backend::bitsliced})
+        {
+            if (!aes::isSupported(backend)) continue;
+
+            aes::Cmac<256> cmac{key, backend};
+            REQUIRE(cmac.generate(data) == tag);
+            REQUIRE(cmac.generate(data.data(), data.size()) == tag);
+
+            // streaming in uneven pieces
+            for (std::size_t step : {1, 15, 16, 17, 100})
+            {
+                for (std::size_t offset = 0; offset < data.size(); offset += step)
+                    cmac.update(data.data() + offset, std::min(step, data.size() - offset));
+                REQUIRE(cmac.finalize() == tag);
+            }
+
+            cmac.update(data.begin(), data.begin() + 50);
+            cmac.reset();
+            cmac.update(data);
+            REQUIRE(cmac.finalize() == tag);
+
+            // messages of all sizes around the block boundaries, some with a wrong tag
+            std::vector<std::array<std::uint8_t, 16>> tags;
+            std::vector<aes::CmacJob> jobs;
+            for (std::size_t size = 0; size <= data.size(); size += 3)
+            {
+                tags.push_back(cmac.generate(data.data(), size));
+                if (size % 4 == 0) tags.back()[size % 16] ^= 0x80;
+            }
+            for (std::size_t i = 0; i < tags.size(); ++i)
+                jobs.push_back({data.data(), i * 3, tags[i].data()});
+
+            const auto results = std::make_unique<bool[]>(jobs.size());
+            cmac.verify(jobs.data(), jobs.size(), results.get());
+            for (std::size_t i = 0; i < jobs.size(); ++i)
+                REQUIRE(results[i] == ((i * 3) % 4 != 0));
+        }
+    }
+
+    SECTION("XTS")
+    {
+        // IEEE 1619 vectors 2 and 15 and three data units with ciphertext stealing
+        std::vector<std::uint8_t> data3(104);
+        for (std::size_t i = 0; i < data3.size(); ++i)
+            data3[i] = static_cast<std::uint8_t>(i * 3);
+
+        std::vector<std::uint8_t> key3(64);
+        for (std::size_t i = 0; i < key3.size(); ++i)
+            key3[i] = static_cast<std::uint8_t>(i);
+
+        const struct final
+        {
+            std::vector<std::uint8_t> key;
+            std::size_t dataUnitSize;
+            std::uint64_t dataUnitNumber;
+            std::vector<std::uint8_t> data;
+            std::vector<std::uint8_t> result;
+        } testCasesXts128[] = {
+            {{
+                0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22
+            }, 32, 0x3333333333, std::vector<std::uint8_t>(32, 0x44), {
+                0xC4, 0x54, 0x18, 0x5E, 0x6A, 0x16, 0x93, 0x6E, 0x39, 0x33, 0x40, 0x38, 0xAC, 0xEF, 0x83, 0x8B,
+                0xFB, 0x18, 0x6F, 0xFF, 0x74, 0x80, 0xAD, 0xC4, 0x28, 0x93, 0x82, 0xEC, 0xD6, 0xD3, 0x94, 0xF0
+            }},
+            {{
+                0xFF, 0xFE, 0xFD, 0xFC, 0xFB, 0xFA, 0xF9, 0xF8, 0xF7, 0xF6, 0xF5, 0xF4, 0xF3, 0xF2, 0xF1, 0xF0,
+                0xBF, 0xBE, 0xBD, 0xBC, 0xBB, 0xBA, 0xB9, 0xB8, 0xB7, 0xB6, 0xB5, 0xB4, 0xB3, 0xB2, 0xB1, 0xB0
+            }, 17, 0x123456789A, {
+                0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10
+            }, {
+                0x6C, 0x16, 0x25, 0xDB, 0x46, 0x71, 0x52, 0x2D, 0x3D, 0x75, 0x99, 0x60, 0x1D, 0xE7, 0xCA, 0x09, 0xED
+            }}
+        };
+
+        for (const auto& testCase : testCasesXts128)
+        {
+            const auto e = aes::encryptXts<128>(testCase.data, testCase.key, testCase.dataUnitSize, testCase.dataUnitNumber);
+            REQUIRE(e == testCase.result);
+
+            const auto d = aes::decryptXts<128>(e, testCase.key, testCase.dataUnitSize, testCase.dataUnitNumber);
+            REQUIRE(d == testCase.data);
+        }
+
+        const std::vector<std::uint8_t> result3{
+            0x84, 0xEB, 0x3B, 0x01, 0x53, 0x2B, 0xD4, 0xED, 0xF8, 0x0B, 0xF2, 0x64, 0xEC, 0x8B, 0xC6, 0x63,
+            0x14, 0x57, 0x5A, 0xAB, 0xEF, 0x11, 0x97, 0x38, 0x96, 0xDE, 0x54, 0xE9, 0x7A, 0x92, 0xD5, 0x62,
+            0x60, 0xC7, 0x38, 0x20, 0x83, 0xF8, 0x4F, 0x58, 0xEA, 0xA8, 0xD9, 0x9C, 0xF6, 0xE6, 0x1D, 0x91,
+            0xFF, 0xBE, 0x8F, 0x8E, 0xDF, 0x90, 0xDF, 0xB8, 0x0B, 0xA6, 0xFD, 0x39, 0xCA, 0x63, 0x37, 0xA7,
+            0x1C, 0xFC, 0x42, 0x84, 0xED, 0x79, 0x52, 0x21, 0xAD, 0x93, 0x8C, 0x4A, 0x62, 0xDB, 0x09, 0xDF,
+            0x4D, 0x9D, 0x06, 0xCF, 0x3C, 0x35, 0xCF, 0xD6, 0xCC, 0x37, 0x6C, 0x7C, 0xD5, 0x44, 0x92, 0x58,
+            0x5F, 0xD8, 0xD3, 0x6C, 0x69, 0x08, 0xDE, 0x75
+        };
+
+        for (const auto backend : {aes::Backend::reference, aes::Backend::table, aes::Backend::hardware, aes::Backend::bitsliced})
+        {
+            if (!aes::isSupported(backend)) continue;
+
+            const aes::XtsCipher<256> cipher{key3, 40, backend};
+            REQUIRE(cipher.encrypt(data3, 7) == result3);
+            REQUIRE(cipher.decrypt(result3, 7) == data3);
+
+            // a data unit at a time
+            auto inPlace = data3;
+            for (std::size_t i = 0; i < 3; ++i)
+                cipher.encrypt(inPlace.data() + i * 40, std::min(std::size_t{40}, inPlace.size() - i * 40), inPlace.data() + i * 40, 7 + i);
+            REQUIRE(inPlace == result3);
+        }
+
+        REQUIRE_THROWS_AS(aes::XtsCipher<128>(key3, 15), aes::DataSizeError);
+        REQUIRE_THROWS_AS(aes::XtsCipher<128>(std::vector<std::uint8_t>(32), 32), std::invalid_argument);
+        REQUIRE_THROWS_AS(aes::XtsCipher<256>(key3, aes::XtsCipher<256>::maxDataUnitSize + 1), std::invalid_argument);
+        REQUIRE(aes::XtsCipher<256>(key3, aes::XtsCipher<256>::maxDataUnitSize).getDataUnitSize() == aes::XtsCipher<256>::maxDataUnitSize);
+        REQUIRE_THROWS_AS(aes::encryptXts<256>(std::vector<std::uint8_t>(50), key3, 40, 0), aes::DataSizeError);
+
+        // many data units on several threads
+        std::vector<std::uint8_t> sectors(4096 * 64);
+        for (std::size_t i = 0; i < sectors.size(); ++i)
+            sectors[i] = static_cast<std::uint8_t>(i * 31);
+
+        aes::XtsCipher<256> cipher{key3, 4096};
+        const auto e = cipher.encrypt(sectors, 1000);
+        cipher.setThreadCount(4);
+        REQUIRE(cipher.encrypt(sectors, 1000) == e);
+        REQUIRE(cipher.decrypt(e, 1000) == sectors);
+    }
+
+    SECTION("Batch")
+    {
+        // more jobs than lanes with different sizes and keys
+        const std::size_t sizes[] = {64, 0, 512, 1, 100, 16, 17, 256, 64, 48, 500, 33};
+        constexpr std::size_t jobCount = sizeof(sizes) / sizeof(sizes[0]);
+
+        std::vector<std::vector<std::uint8_t>> keys(jobCount, std::vector<std::uint8_t>(32));
+        std::vector<std::vector<std::uint8_t>> initVectors(jobCount, std::vector<std::uint8_t>(16));
+        std::vector<std::vector<std::uint8_t>> inputs(jobCount);
+        for (std::size_t i = 0; i < jobCount; ++i)
+        {
+            for (std::size_t j = 0; j < 32; ++j) keys[i][j] = static_cast<std::uint8_t>(i * 7 + j);
+            for (std::size_t j = 0; j < 16; ++j) initVectors[i][j] = static_cast<std::uint8_t>(i * 5 + j * 3);
+            inputs[i].resize(sizes[i]);
+            for (std::size_t j = 0; j < sizes[i]; ++j) inputs[i][j] = static_cast<std::uint8_t>(i + j * 13);
+        }
+
+        for (const auto backend : {aes::Backend::reference, aes::Backend::table, aes::Backend::hardware, aes::Backend::bitsliced})
+        {
+            if (!aes::isSupported(backend)) continue;
+
+            const auto check = [&](const auto& batch, const auto& single) {
+                std::vector<std::vector<std::uint8_t>> outputs(jobCount);
+                std::vector<aes::Job> jobs(jobCount);
+                for (std::size_t i = 0; i < jobCount; ++i)
+                {
+                    outputs[i] = inputs[i];
+                    outputs[i].resize(aes::getPaddedSize(sizes[i]));
+                    // in place
+                    jobs[i] = {keys[i].data(), initVectors[i].data(), outputs[i].data(), sizes[i], outputs[i].data()};
+                }
+
+                batch(jobs.data(), jobs.size(), backend);
+
+                for (std::size_t i = 0; i < jobCount; ++i)
+                {
+                    const auto expected = single(aes::Cipher<256>{keys[i]}, inputs[i], initVectors[i]);
+                    REQUIRE(std::equal(expected.begin(), expected.end(), outputs[i].begin()));
+                }
+            };
+
+            check(aes::encryptBatch<256, aes::Mode::ecb>, [](const auto& cipher, const auto& input, const auto&) { return cipher.encryptEcb(input); });
+            check(aes::decryptBatch<256, aes::Mode::ecb>, [](const auto& cipher, const auto& input, const auto&) { return cipher.decryptEcb(input); });
+            check(aes::encryptBatch<256, aes::Mode::cbc>, [](const auto& cipher, const auto& input, const auto& iv) { return cipher.encryptCbc(input, iv); });
+            check(aes::decryptBatch<256, aes::Mode::cbc>, [](const auto& cipher, const auto& input, const auto& iv) { return cipher.decryptCbc(input, iv); });
+            check(aes::encryptBatch<256, aes::Mode::cfb>, [](const auto& cipher, const auto& input, const auto& iv) { return cipher.encryptCfb(input, iv); });
+            check(aes::decryptBatch<256, aes::Mode::cfb>, [](const auto& cipher, const auto& input, const auto& iv) { return cipher.decryptCfb(input, iv); });
+            check(aes::encryptBatch<256, aes::Mode::ctr>, [](const auto& cipher, const auto& input, const auto& iv) { return cipher.encryptCtr(input, iv); });
+            check(aes::decryptBatch<256, aes::Mode::ctr>, [](const auto& cipher, const auto& input, const auto& iv) { return cipher.decryptCtr(input, iv); });
+        }
+    }
+
+    SECTION("Streaming")
+    {
+        std::vector<std::uint8_t> data(1000);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<std::uint8_t>(i * 13);
+
+        const aes::Cipher<256> cipher{key};
+
+        for (const std::size_t chunkSize : {std::size_t{1}, std::size_t{7}, std::size_t{16}, std::size_t{100}, std::size_t{1000}})
+        {
+            const auto stream = [chunkSize](auto context, const std::vector<std::uint8_t>& input) {
+                std::vector<std::uint8_t> result;
+                for (std::size_t offset = 0; offset < input.size(); offset += chunkSize)
+                {
+                    const auto chunkBegin = input.begin() + static_cast<std::ptrdiff_t>(offset);
+                    const auto chunkEnd = input.begin() + static_cast<std::ptrdiff_t>(std::min(offset + chunkSize, input.size()));
+                    context.update(chunkBegin, chunkEnd, std::back_inserter(result));
+                }
+                context.finalize(std::back_inserter(result));
+                return result;
+            };
+
+            // the pointer overload, in place, with the block modes writing the padded tail on finalize
+            const auto streamBuffer = [chunkSize](auto context, const std::vector<std::uint8_t>& input) {
+                std::vector<std::uint8_t> result = input;
+                std::uint8_t* output = result.data();
+                for (std::size_t offset = 0; offset < input.size(); offset += chunkSize)
+                    output = context.update(result.data() + offset, std::min(chunkSize, input.size() - offset), output);
+                result.resize(static_cast<std::size_t>(output - result.data()));
+                context.finalize(std::back_inserter(result));
+                return result;
+            };
+
+            const auto ecb = stream(aes::Encryptor<256, aes::Mode::ecb>{cipher}, data);
+            REQUIRE(ecb == cipher.encryptEcb(data));
+            REQUIRE(stream(aes::Decryptor<256, aes::Mode::ecb>{cipher}, ecb) == cipher.decryptEcb(ecb));
+
+            const auto cbc = stream(aes::Encryptor<256, aes::Mode::cbc>{cipher, initVector}, data);
+            REQUIRE(cbc == cipher.encryptCbc(data, initVector));
+            REQUIRE(stream(aes::Decryptor<256, aes::Mode::cbc>{cipher, initVector}, cbc) == cipher.decryptCbc(cbc, initVector));
+
+            const auto cfb = stream(aes::Encryptor<256, aes::Mode::cfb>{cipher, initVector}, data);
+            REQUIRE(cfb == cipher.encryptCfb(data, initVector));
+            REQUIRE(stream(aes::Decryptor<256, aes::Mode::cfb>{cipher, initVector}, cfb) == cipher.decryptCfb(cfb, initVector));
+
+            const auto ctr = stream(aes::Encryptor<256, aes::Mode::ctr>{cipher, initVector}, data);
+            REQUIRE(ctr == cipher.encryptCtr(data, initVector));
+            REQUIRE(stream(aes::Decryptor<256, aes::Mode::ctr>{cipher, initVector}, ctr) == data);
+
+            REQUIRE(streamBuffer(aes::Encryptor<256, aes::Mode::ecb>{cipher}, data) == ecb);
+            REQUIRE(streamBuffer(aes::Decryptor<256, aes::Mode::ecb>{cipher}, ecb) == cipher.decryptEcb(ecb));
+            REQUIRE(streamBuffer(aes::Encryptor<256, aes::Mode::cbc>{cipher, initVector}, data) == cbc);
+            REQUIRE(streamBuffer(aes::Decryptor<256, aes::Mode::cbc>{cipher, initVector}, cbc) == cipher.decryptCbc(cbc, initVector));
+            REQUIRE(streamBuffer(aes::Encryptor<256, aes::Mode::cfb>{cipher, initVector}, data) == cfb);
+            REQUIRE(streamBuffer(aes::Decryptor<256, aes::Mode::cfb>{cipher, initVector}, cfb) == cipher.decryptCfb(cfb, initVector));
+            REQUIRE(streamBuffer(aes::Encryptor<256, aes::Mode::ctr>{cipher, initVector}, data) == ctr);
+            REQUIRE(streamBuffer(aes::Decryptor<256, aes::Mode::ctr>{cipher, initVector}, ctr) == data);
+        }
+    }
+
+    SECTION("Buffers")
+    {
+        const aes::Cipher<256> cipher{key};
+
+        for (const std::size_t size : {std::size_t{0}, std::size_t{1}, std::size_t{15}, std::size_t{16}, std::size_t{17}, std::size_t{129}, std::size_t{1000}})
+        {
+            // odd offset to not rely on the alignment of the buffers
+            std::vector<std::uint8_t> buffer(size + 1 + 32);
+            for (std::size_t i = 0; i < buffer.size(); ++i)
+                buffer[i] = static_cast<std::uint8_t>(i * 7);
+            const std::vector<std::uint8_t> data(buffer.begin() + 1, buffer.begin() + 1 + static_cast<std::ptrdiff_t>(size));
+
+            const auto check = [&](const std::vector<std::uint8_t>& expected, const auto& process) {
+                std::vector<std::uint8_t> output(expected.size() + 1);
+                process(data.data(), output.data() + 1);
+                REQUIRE(std::vector<std::uint8_t>(output.begin() + 1, output.end()) == expected);
+
+                // in place
+                auto inPlace = buffer;
+                process(inPlace.data() + 1, inPlace.data() + 1);
+                REQUIRE(std::vector<std::uint8_t>(inPlace.begin() + 1, inPlace.begin() + 1 + static_cast<std::ptrdiff_t>(expected.size())) == expected);
+            };
+
+            REQUIRE(aes::getPaddedSize(size) == cipher.encryptEcb(data).size());
+
+            check(cipher.encryptEcb(data), [&](const std::uint8_t* in, std::uint8_t* out) { cipher.encryptEcb(in, size, out); });
+            check(cipher.decryptEcb(data), [&](const std::uint8_t* in, std::uint8_t* out) { cipher.decryptEcb(in, size, out); });
+            check(cipher.encryptCbc(data, initVector), [&](const std::uint8_t* in, std::uint8_t* out) { cipher.encryptCbc(in, size, out, initVector); });
+            check(cipher.decryptCbc(data, initVector), [&](const std::uint8_t* in, std::uint8_t* out) { cipher.decryptCbc(in, size, out, initVector); });
+            check(cipher.encryptCfb(data, initVector), [&](const std::uint8_t* in, std::uint8_t* out) { cipher.encryptCfb(in, size, out, initVector); });
+            check(cipher.decryptCfb(data, initVector), [&](const std::uint8_t* in, std::uint8_t* out) { cipher.decryptCfb(in, size, out, initVector); });
+            check(cipher.encryptCtr(data, initVector), [&](const std::uint8_t* in, std::uint8_t* out) { cipher.encryptCtr(in, size, out, initVector); });
+            check(aes::encryptCbc<256>(data, key, initVector), [&](const std::uint8_t* in, std::uint8_t* out) { aes::encryptCbc<256>(in, size, out, key, initVector); });
+
+            const std::array<std::uint8_t, 12> gcmInitVector{};
+            const auto gcm = cipher.encryptGcm(data, gcmInitVector, initVector);
+            check(gcm, [&](const std::uint8_t* in, std::uint8_t* out) { cipher.encryptGcm(in, size, out, gcmInitVector, initVector); });
+
+            std::vector<std::uint8_t> plaintext(size);
+            cipher.decryptGcm(gcm.data(), gcm.size(), plaintext.data(), gcmInitVector, initVector);
+            REQUIRE(plaintext == data);
+        }
+
+        // single pass input iterators
+        std::istringstream stream{"single pass input"};
+        const std::string text = stream.str();
+        REQUIRE(cipher.encryptCbc(std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}, initVector) ==
+                cipher.encryptCbc(text, initVector));
+    }
+
+    SECTION("Cipher")
+    {
+        const std::vector<std::uint8_t> data{'T', 'e', 's', 't', ' ', '1', '2', '!', '1', '2', '3', '4', '5', '6', '7', '8', '9', '.', '.'};
+
+        // more blocks than are processed together
+        std::vector<std::uint8_t> longData(13 * 16 + 5);
+        for (std::size_t i = 0; i < longData.size(); ++i)
+            longData[i] = static_cast<std::uint8_t>(i * 11);
+
+        for (const auto backend : {aes::Backend::reference, aes::Backend::table, aes::Backend::hardware, aes::Backend::bitsliced})
+        {
+            if (!aes::isSupported(backend)) continue;
+
+            const aes::Cipher<256> cipher{key, backend};
+
+            REQUIRE(cipher.encryptEcb(data) == aes::encryptEcb<256>(data, key));
+            REQUIRE(cipher.encryptCbc(data, initVector) == aes::encryptCbc<256>(data, key, initVector));
+            REQUIRE(cipher.encryptCfb(data, initVector) == aes::encryptCfb<256>(data, key, initVector));
+            REQUIRE(cipher.encryptEcb(longData) == aes::encryptEcb<256>(longData, key));
+            REQUIRE(cipher.decryptEcb(longData) == aes::decryptEcb<256>(longData, key));
+            REQUIRE(cipher.encryptCtr(longData, initVector) == aes::encryptCtr<256>(longData, key, initVector));
+
+            const auto ecb = cipher.decryptEcb(cipher.encryptEcb(data));
+            REQUIRE(std::equal(data.begin(), data.end(), ecb.begin()));
+
+            const auto cbc = cipher.decryptCbc(cipher.encryptCbc(data, initVector), initVector);
+            REQUIRE(std::equal(data.begin(), data.end(), cbc.begin()));
+
+            const auto cfb = cipher.decryptCfb(cipher.encryptCfb(data, initVector), initVector);
+            REQUIRE(std::equal(data.begin(), data.end(), cfb.begin()));
+        }
+    }
+
+    SECTION("Key cache")
+    {
+        const std::vector<std::uint8_t> data{'T', 'e', 's', 't', ' ', '1', '2', '!', '1', '2', '3', '4', '5', '6', '7', '8', '9', '.', '.'};
+
+        std::vector<std::vector<std::uint8_t>> keys(3, std::vector<std::uint8_t>(key.begin(), key.end()));
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            keys[i][0] = static_cast<std::uint8_t>(i);
+
+        for (const auto backend : {aes::Backend::reference, aes::Backend::table, aes::Backend::hardware, aes::Backend::bitsliced})
+        {
+            if (!aes::isSupported(backend))
+            {
+                REQUIRE_THROWS_AS(aes::KeyCache<256>(2, backend), aes::BackendError);
+                continue;
+            }
+
+            aes::KeyCache<256> cache{2, backend, 1};
+            REQUIRE(cache.getCapacity() == 2);
+
+            const auto cipher = cache.get(keys[0]);
+            REQUIRE(cipher->getBackend() == backend);
+            REQUIRE(cipher->encryptCbc(data, initVector) == aes::encryptCbc<256>(data, keys[0], initVector));
+            REQUIRE(cipher->decryptCbc(cipher->encryptCbc(data, initVector), initVector) ==
+                    aes::decryptCbc<256>(aes::encryptCbc<256>(data, keys[0], initVector), keys[0], initVector));
+
+            REQUIRE(cache.get(keys[0]) == cipher);
+            REQUIRE(cache.getHitCount() == 1);
+            REQUIRE(cache.getMissCount() == 1);
+
+            // the third key evicts the second one, which was not referenced again
+            const auto evicted = cache.get(keys[1]);
+            REQUIRE(evicted != cipher);
+            REQUIRE(cache.get(keys[2])->encryptEcb(data) == aes::encryptEcb<256>(data, keys[2]));
+            REQUIRE(cache.getSize() == 2);
+            REQUIRE(cache.getMissCount() == 3);
+
+            REQUIRE(cache.get(keys[0]) == cipher);
+            const auto reloaded = cache.get(keys[1]);
+            REQUIRE(reloaded != evicted);
+            REQUIRE(cache.getHitCount() == 2);
+            REQUIRE(cache.getMissCount() == 4);
+            REQUIRE(evicted->encryptEcb(data) == reloaded->encryptEcb(data));
+
+            cache.clear();
+            REQUIRE(cache.getSize() == 0);
+            REQUIRE(cache.getHitCount() == 2);
+        }
+
+        REQUIRE_THROWS_AS(aes::KeyCache<256>(0), std::invalid_argument);
+        REQUIRE(aes::KeyCache<256>(1000).getCapacity() == 1000);
+        REQUIRE(aes::KeyCache<256>(3, aes::getDefaultBackend(), 16).getCapacity() == 3);
+
+        // every shard holds its share of the capacity
+        aes::KeyCache<256> boundedCache{5, aes::getDefaultBackend(), 2};
+        for (std::uint8_t i = 0; i < 32; ++i)
+        {
+            std::vector<std::uint8_t> boundedKey(key.begin(), key.end());
+            boundedKey[1] = i;
+            (void)boundedCache.get(boundedKey);
+        }
+        REQUIRE(boundedCache.getSize() == 5);
+
+        // concurrent lookups of a few keys from several threads
+        aes::KeyCache<256> cache{64};
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < 4; ++t)
+            threads.emplace_back([&cache, &keys]() {
+                for (std::size_t i = 0; i < 300; ++i)
+                    (void)cache.get(keys[i % keys.size()]);
+            });
+        for (auto& thread : threads)
+            thread.join();
+
+        REQUIRE(cache.getHitCount() + cache.getMissCount() == 1200);
+        REQUIRE(cache.getSize() == keys.size());
+        REQUIRE(cache.get(keys[1])->encryptEcb(data) == aes::encryptEcb<256>(data, keys[1]));
+    }
+
+    SECTION("Backends")
+    {
+        // FIPS-197 appendix C example vectors
+        const std::vector<std::uint8_t> key128{
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+            0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+        };
+        const std::vector<std::uint8_t> key192{
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+            0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+            0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17
+        };
+        const std::vector<std::uint8_t> key256(key.begin(), key.end());
+
+        for (const auto backend : {aes::Backend::reference, aes::Backend::table, aes::Backend::hardware, aes::Backend::bitsliced})
+        {
+            if (!aes::isSupported(backend))
+            {
+                REQUIRE_THROWS_AS(aes::Cipher<256>(key, backend), aes::BackendError);
+                continue;
+            }
+
+            testBackend<128>(backend, key128, {0x69, 0xC4, 0xE0, 0xD8, 0x6A, 0x7B, 0x04, 0x30, 0xD8, 0xCD, 0xB7, 0x80, 0x70, 0xB4, 0xC5, 0x5A});
+            testBackend<192>(backend, key192, {0xDD, 0xA9, 0x7C, 0xA4, 0x86, 0x4C, 0xDF, 0xE0, 0x6E, 0xAF, 0x70, 0xA0, 0xEC, 0x0D, 0x71, 0x91});
+            testBackend<256>(backend, key256, {0x8E, 0xA2, 0xB7, 0xCA, 0x51, 0x67, 0x45, 0xBF, 0xEA, 0xFC, 0x49, 0x90, 0x4B, 0x49, 0x60, 0x89});
+        }
+    }
+
+    SECTION("Constant expressions")
+    {
+        // FIPS-197 appendix C.1
+        constexpr std::array<std::uint8_t, 16> key128{
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+        };
+        constexpr std::array<std::uint8_t, 16> plainText{
+            0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF
+        };
+        constexpr std::array<std::uint8_t, 16> cipherText{
+            0x69, 0xC4, 0xE0, 0xD8, 0x6A, 0x7B, 0x04, 0x30, 0xD8, 0xCD, 0xB7, 0x80, 0x70, 0xB4, 0xC5, 0x5A
+        };
+
+        static_assert(isEqual(aes::encryptEcbArray<128>(plainText, key128), cipherText));
+        static_assert(isEqual(aes::decryptEcbArray<128>(cipherText, key128), plainText));
+
+        constexpr std::array<std::uint8_t, 37> data{
+            'C', 'o', 'n', 's', 't', 'a', 'n', 't', ' ', 'e', 'x', 'p', 'r', 'e', 's', 's', 'i', 'o', 'n',
+            's', ' ', 'a', 't', ' ', 'c', 'o', 'm', 'p', 'i', 'l', 'e', ' ', 't', 'i', 'm', 'e', '.'
+        };
+
+        constexpr auto ecb = aes::encryptEcbArray<256>(data, key);
+        constexpr auto cbc = aes::encryptCbcArray<256>(data, key, initVector);
+        constexpr auto cfb = aes::encryptCfbArray<256>(data, key, initVector);
+        static_assert(ecb.size() == 48 && cbc.size() == 48 && cfb.size() == 48);
+
+        REQUIRE(std::vector<std::uint8_t>(ecb.begin(), ecb.end()) == aes::encryptEcb<256>(data, key));
+        REQUIRE(std::vector<std::uint8_t>(cbc.begin(), cbc.end()) == aes::encryptCbc<256>(data, key, initVector));
+        REQUIRE(std::vector<std::uint8_t>(cfb.begin(), cfb.end()) == aes::encryptCfb<256>(data, key, initVector));
+
+        constexpr auto ecbDecrypted = aes::decryptEcbArray<256>(ecb, key);
+        constexpr auto cbcDecrypted = aes::decryptCbcArray<256>(cbc, key, initVector);
+        constexpr auto cfbDecrypted = aes::decryptCfbArray<256>(cfb, key, initVector);
+        REQUIRE(std::equal(data.begin(), data.end(), ecbDecrypted.begin()));
+        REQUIRE(std::equal(data.begin(), data.end(), cbcDecrypted.begin()));
+        REQUIRE(std::equal(data.begin(), data.end(), cfbDecrypted.begin()));
+    }
+
     SECTION("Byte")
     {
         constexpr std::array<std::byte, 32> keyByte{
@@ -0,0 +1,76 @@
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+#include "catch2/catch.hpp"
+#include "hmac.hpp"
+#include "sha2.hpp"
+
+namespace
+{
+    template <class T>
+    std::string toString(const T& v)
+    {
+        constexpr char digits[] = "0123456789abcdef";
+
+        std::string result;
+        for (const auto b : v)
+        {
+            result += digits[(b >> 4) & 0x0F];
+            result += digits[b & 0x0F];
+        }
+
+        return result;
+    }
+
+    using Hmac = hmac::BasicHmac<sha256::Hasher, sha256::blockByteCount, sha256::digestByteCount>;
+}
+
+TEST_CASE("HMAC", "[hmac]")
+{
+    // RFC 4231 test case 2
+    const std::string key = "Jefe";
+    const std::string data = "what do ya want for nothing?";
+    const std::string result = "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843";
+
+    SECTION("Generate")
+    {
+        const Hmac hmac{key};
+        const std::vector<std::uint8_t> bytes(data.begin(), data.end());
+        const std::list<char> list(data.begin(), data.end());
+        REQUIRE(toString(hmac.generate(data)) == result);
+        REQUIRE(toString(hmac.generate(bytes.data(), bytes.size())) == result);
+        REQUIRE(toString(hmac.generate(list.begin(), list.end())) == result);
+        REQUIRE(toString(Hmac{std::vector<std::uint8_t>(key.begin(), key.end())}.generate(data)) == result);
+    }
+
+    SECTION("Verify")
+    {
+        const Hmac hmac{key};
+        REQUIRE(hmac.verify(data, hmac.generate(data)));
+        REQUIRE_FALSE(hmac.verify(data + "!", hmac.generate(data)));
+        REQUIRE_FALSE(hmac.verify(data, std::string{"short"}));
+
+        const std::vector<std::uint8_t> bytes(data.begin(), data.end());
+        auto tag = hmac.generate(bytes.data(), bytes.size());
+        REQUIRE(hmac.verify(bytes.data(), bytes.size(), tag.data()));
+        tag[0] ^= 1U;
+        REQUIRE_FALSE(hmac.verify(bytes.data(), bytes.size(), tag.data()));
+    }
+
+    SECTION("Streaming")
+    {
+        // finalize resets to the keyed state
+        Hmac hmac{key};
+        hmac.update(std::string{"what do ya want "});
+        hmac.update(std::string{"for nothing?"});
+        REQUIRE(toString(hmac.finalize()) == result);
+        hmac.update(data);
+        REQUIRE(toString(hmac.finalize()) == result);
+
+        hmac.update(std::string{"discarded"});
+        hmac.reset();
+        hmac.update(data.begin(), data.end());
+        REQUIRE(toString(hmac.finalize()) == result);
+    }
+}
@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <list>
 #include <string>
 #include <vector>
 #include "catch2/catch.hpp"
@@ -77,4 +80,114 @@ TEST_CASE("MD5", "[md5]")
         const auto str = toString(h);
         REQUIRE(str == testCase.result);
     }
+
+    SECTION("Incremental")
+    {
+        md5::Hasher hasher;
+        hasher.update(std::string{"a"});
+        hasher.update(std::string{"bc"});
+        REQUIRE(toString(hasher.finalize()) == "900150983cd24fb0d6963f7d28e17f72");
+
+        // finalize resets the hasher
+        hasher.update(std::string{"abc"});
+        REQUIRE(toString(hasher.finalize()) == "900150983cd24fb0d6963f7d28e17f72");
+
+        std::vector<std::uint8_t> data(200);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<std::uint8_t>(i * 7);
+
+        const auto expected = md5::hash(data);
+
+        for (const std::size_t split : {0, 1, 55, 56, 63, 64, 65, 128, 199, 200})
+        {
+            hasher.update(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(split));
+            hasher.update(data.begin() + static_cast<std::ptrdiff_t>(split), data.end());
+            REQUIRE(hasher.finalize() == expected);
+        }
+
+        hasher.update(data);
+        hasher.reset();
+        hasher.update(std::string{"abc"});
+        REQUIRE(toString(hasher.finalize()) == "900150983cd24fb0d6963f7d28e17f72");
+    }
+
+    SECTION("Contiguous")
+    {
+        // the pointers, vectors and strings are hashed in place, lists byte by byte
+        for (const std::size_t size : {0, 1, 63, 64, 65, 127, 128, 1000})
+        {
+            std::string data(size, '\0');
+            for (std::size_t i = 0; i < data.size(); ++i)
+                data[i] = static_cast<char>(i * 13 + 5);
+
+            const auto expected = md5::hash(std::list<char>(data.begin(), data.end()));
+            REQUIRE(md5::hash(data) == expected);
+            REQUIRE(md5::hash(std::vector<std::byte>(reinterpret_cast<const std::byte*>(data.data()),
+                                                     reinterpret_cast<const std::byte*>(data.data() + data.size()))) == expected);
+
+            md5::Hasher hasher;
+            for (std::size_t i = 0; i < data.size(); i += 17)
+                hasher.update(data.data() + i, data.data() + std::min(i + 17, data.size()));
+            REQUIRE(hasher.finalize() == expected);
+        }
+    }
+
+    SECTION("Batch")
+    {
+        // messages of unequal lengths, so that the lanes end and are refilled at different blocks
+        std::vector<std::vector<std::uint8_t>> messages(40);
+        for (std::size_t i = 0; i < messages.size(); ++i)
+        {
+            messages[i].resize((i * 37) % 300);
+            for (std::size_t j = 0; j < messages[i].size(); ++j)
+                messages[i][j] = static_cast<std::uint8_t>(i * 11 + j * 7);
+        }
+
+        const auto testBatch = [&messages](const auto hashJobs) {
+            std::vector<std::array<std::uint8_t, md5::digestByteCount>> digests(messages.size());
+            std::vector<md5::Job> jobs(messages.size());
+            for (std::size_t i = 0; i < messages.size(); ++i)
+                jobs[i] = {messages[i].data(), messages[i].size(), digests[i].data()};
+
+            hashJobs(jobs.data(), jobs.size());
+
+            for (std::size_t i = 0; i < messages.size(); ++i)
+                REQUIRE(digests[i] == md5::hash(messages[i]));
+        };
+
+        testBatch([](const md5::Job* jobs, const std::size_t count) { md5::hashBatch(jobs, count); });
+        testBatch([](const md5::Job* jobs, const std::size_t count) { md5::hashBatch(jobs, count / 2); md5::hashBatch(jobs + count / 2, count - count / 2); });
+
+#ifdef MD5_X86
+        if (md5::getCpuFeatures().sse2)
+            testBatch([](const md5::Job* jobs, const std::size_t count) { md5::hashLanes<4>(jobs, count, md5::transformLanesSse2); });
+        if (md5::getCpuFeatures().avx2)
+            testBatch([](const md5::Job* jobs, const std::size_t count) { md5::hashLanes<8>(jobs, count, md5::transformLanesAvx2); });
+        if (md5::getCpuFeatures().avx512)
+            testBatch([](const md5::Job* jobs, const std::size_t count) { md5::hashLanes<16>(jobs, count, md5::transformLanesAvx512); });
+#endif
+    }
+
+    SECTION("HMAC")
+    {
+        // RFC 2202 and RFC 4231 test cases, the last key is longer than a block
+        const struct final
+        {
+            std::string key;
+            std::string data;
+            std::string result;
+        } testCases[] = {
+            {std::string(16, '\x0B'), "Hi There", "9294727a3638bb1c13f48ef8158bfc9d"},
+            {"Jefe", "what do ya want for nothing?", "750c783e6ab0b503eaa86e310a5db738"},
+            {std::string(131, '\xAA'), "Test Using Larger Than Block-Size Key - Hash Key First", "bfecaf4efff90a3a668f3922fec3762d"}
+        };
+
+        for (const auto& testCase : testCases)
+        {
+            const md5::Hmac hmac{testCase.key};
+            REQUIRE(toString(hmac.generate(testCase.data)) == testCase.result);
+            REQUIRE(toString(md5::generateHmac(testCase.data, testCase.key)) == testCase.result);
+            REQUIRE(md5::verifyHmac(testCase.data, testCase.key, hmac.generate(testCase.data)));
+        }
+    }
 }
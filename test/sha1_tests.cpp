@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cstddef>
+#include <list>
 #include <string>
 #include <vector>
 #include "catch2/catch.hpp"
@@ -77,4 +79,101 @@ TEST_CASE("SHA1", "[sha1]")
         const auto str = toString(h);
         REQUIRE(str == testCase.result);
     }
+
+    SECTION("Incremental")
+    {
+        sha1::Hasher hasher;
+        hasher.update(std::string{"a"});
+        hasher.update(std::string{"bc"});
+        REQUIRE(toString(hasher.finalize()) == "a9993e364706816aba3e25717850c26c9cd0d89d");
+
+        // finalize resets the hasher
+        hasher.update(std::string{"abc"});
+        REQUIRE(toString(hasher.finalize()) == "a9993e364706816aba3e25717850c26c9cd0d89d");
+
+        std::vector<std::uint8_t> data(200);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<std::uint8_t>(i * 7);
+
+        const auto expected = sha1::hash(data);
+
+        for (const std::size_t split : {0, 1, 55, 56, 63, 64, 65, 128, 199, 200})
+        {
+            hasher.update(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(split));
+            hasher.update(data.begin() + static_cast<std::ptrdiff_t>(split), data.end());
+            REQUIRE(hasher.finalize() == expected);
+        }
+
+        hasher.update(data);
+        hasher.reset();
+        hasher.update(std::string{"abc"});
+        REQUIRE(toString(hasher.finalize()) == "a9993e364706816aba3e25717850c26c9cd0d89d");
+    }
+
+    SECTION("Contiguous")
+    {
+        // the pointers, vectors and strings are hashed in place, lists byte by byte
+        for (const std::size_t size : {0, 1, 63, 64, 65, 127, 128, 1000})
+        {
+            std::string data(size, '\0');
+            for (std::size_t i = 0; i < data.size(); ++i)
+                data[i] = static_cast<char>(i * 13 + 5);
+
+            const auto expected = sha1::hash(std::list<char>(data.begin(), data.end()));
+            REQUIRE(sha1::hash(data) == expected);
+            REQUIRE(sha1::hash(std::vector<std::byte>(reinterpret_cast<const std::byte*>(data.data()),
+                                                     reinterpret_cast<const std::byte*>(data.data() + data.size()))) == expected);
+
+            sha1::Hasher hasher;
+            for (std::size_t i = 0; i < data.size(); i += 17)
+                hasher.update(data.data() + i, data.data() + std::min(i + 17, data.size()));
+            REQUIRE(hasher.finalize() == expected);
+        }
+    }
+
+#ifdef SHA1_X86
+    SECTION("Hardware")
+    {
+        if (sha1::getCpuFeatures().sha)
+        {
+            std::vector<std::uint8_t> data(sha1::blockByteCount * 5);
+            for (std::size_t i = 0; i < data.size(); ++i)
+                data[i] = static_cast<std::uint8_t>(i * 31 + (i >> 3));
+
+            for (std::size_t blockCount = 0; blockCount <= 5; ++blockCount)
+            {
+                auto expected = sha1::initialState;
+                for (std::size_t i = 0; i < blockCount; ++i)
+                    sha1::transform(data.data() + i * sha1::blockByteCount, expected);
+
+                auto state = sha1::initialState;
+                sha1::transformBlocksHardware(data.data(), blockCount, state);
+                REQUIRE(state == expected);
+            }
+        }
+    }
+#endif
+
+    SECTION("HMAC")
+    {
+        // RFC 2202 and RFC 4231 test cases, the last key is longer than a block
+        const struct final
+        {
+            std::string key;
+            std::string data;
+            std::string result;
+        } testCases[] = {
+            {std::string(20, '\x0B'), "Hi There", "b617318655057264e28bc0b6fb378c8ef146be00"},
+            {"Jefe", "what do ya want for nothing?", "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79"},
+            {std::string(131, '\xAA'), "Test Using Larger Than Block-Size Key - Hash Key First", "90d0dace1c1bdc957339307803160335bde6df2b"}
+        };
+
+        for (const auto& testCase : testCases)
+        {
+            const sha1::Hmac hmac{testCase.key};
+            REQUIRE(toString(hmac.generate(testCase.data)) == testCase.result);
+            REQUIRE(toString(sha1::generateHmac(testCase.data, testCase.key)) == testCase.result);
+            REQUIRE(sha1::verifyHmac(testCase.data, testCase.key, hmac.generate(testCase.data)));
+        }
+    }
 }
@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <list>
 #include <string>
 #include <vector>
 #include "catch2/catch.hpp"
@@ -77,4 +80,258 @@ TEST_CASE("SHA256", "[sha256]")
         const auto str = toString(h);
         REQUIRE(str == testCase.result);
     }
+
+    SECTION("Incremental")
+    {
+        sha256::Hasher hasher;
+        hasher.update(std::string{"a"});
+        hasher.update(std::string{"bc"});
+        REQUIRE(toString(hasher.finalize()) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+        // finalize resets the hasher
+        hasher.update(std::string{"abc"});
+        REQUIRE(toString(hasher.finalize()) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+        std::vector<std::uint8_t> data(200);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<std::uint8_t>(i * 7);
+
+        const auto expected = sha256::hash(data);
+
+        for (const std::size_t split : {0, 1, 55, 56, 63, 64, 65, 128, 199, 200})
+        {
+            hasher.update(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(split));
+            hasher.update(data.begin() + static_cast<std::ptrdiff_t>(split), data.end());
+            REQUIRE(hasher.finalize() == expected);
+        }
+
+        hasher.update(data);
+        hasher.reset();
+        hasher.update(std::string{"abc"});
+        REQUIRE(toString(hasher.finalize()) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    }
+
+    SECTION("Contiguous")
+    {
+        // the pointers, vectors and strings are hashed in place, lists byte by byte
+        for (const std::size_t size : {0, 1, 63, 64, 65, 127, 128, 1000})
+        {
+            std::string data(size, '\0');
+            for (std::size_t i = 0; i < data.size(); ++i)
+                data[i] = static_cast<char>(i * 13 + 5);
+
+            const auto expected = sha256::hash(std::list<char>(data.begin(), data.end()));
+            REQUIRE(sha256::hash(data) == expected);
+            REQUIRE(sha256::hash(std::vector<std::byte>(reinterpret_cast<const std::byte*>(data.data()),
+                                                     reinterpret_cast<const std::byte*>(data.data() + data.size()))) == expected);
+
+            sha256::Hasher hasher;
+            for (std::size_t i = 0; i < data.size(); i += 17)
+                hasher.update(data.data() + i, data.data() + std::min(i + 17, data.size()));
+            REQUIRE(hasher.finalize() == expected);
+        }
+    }
+
+#ifdef SHA2_X86
+    SECTION("Hardware")
+    {
+        if (sha256::getCpuFeatures().sha)
+        {
+            std::vector<std::uint8_t> data(sha256::blockByteCount * 5);
+            for (std::size_t i = 0; i < data.size(); ++i)
+                data[i] = static_cast<std::uint8_t>(i * 31 + (i >> 3));
+
+            for (std::size_t blockCount = 0; blockCount <= 5; ++blockCount)
+            {
+                auto expected = sha256::initialState;
+                for (std::size_t i = 0; i < blockCount; ++i)
+                    sha256::transform(data.data() + i * sha256::blockByteCount, expected);
+
+                auto state = sha256::initialState;
+                sha256::transformBlocksHardware(data.data(), blockCount, state);
+                REQUIRE(state == expected);
+            }
+        }
+    }
+#endif
+
+    SECTION("Batch")
+    {
+        // messages of unequal lengths, so that the lanes end and are refilled at different blocks
+        std::vector<std::vector<std::uint8_t>> messages(40);
+        for (std::size_t i = 0; i < messages.size(); ++i)
+        {
+            messages[i].resize((i * 37) % 300);
+            for (std::size_t j = 0; j < messages[i].size(); ++j)
+                messages[i][j] = static_cast<std::uint8_t>(i * 11 + j * 7);
+        }
+
+        const auto testBatch = [&messages](const auto hashJobs) {
+            std::vector<std::array<std::uint8_t, sha256::digestByteCount>> digests(messages.size());
+            std::vector<sha256::Job> jobs(messages.size());
+            for (std::size_t i = 0; i < messages.size(); ++i)
+                jobs[i] = {messages[i].data(), messages[i].size(), digests[i].data()};
+
+            hashJobs(jobs.data(), jobs.size());
+
+            for (std::size_t i = 0; i < messages.size(); ++i)
+                REQUIRE(digests[i] == sha256::hash(messages[i]));
+        };
+
+        testBatch([](const sha256::Job* jobs, const std::size_t count) { sha256::hashBatch(jobs, count); });
+        testBatch([](const sha256::Job* jobs, const std::size_t count) { sha256::hashBatch(jobs, count / 2); sha256::hashBatch(jobs + count / 2, count - count / 2); });
+
+#ifdef SHA2_X86
+        if (sha256::getCpuFeatures().avx2)
+            testBatch([](const sha256::Job* jobs, const std::size_t count) { sha256::hashLanes<8>(jobs, count, sha256::transformLanesAvx2); });
+        if (sha256::getCpuFeatures().avx512)
+            testBatch([](const sha256::Job* jobs, const std::size_t count) { sha256::hashLanes<16>(jobs, count, sha256::transformLanesAvx512); });
+#endif
+    }
+
+    SECTION("HMAC")
+    {
+        // RFC 2202 and RFC 4231 test cases, the last key is longer than a block
+        const struct final
+        {
+            std::string key;
+            std::string data;
+            std::string result;
+        } testCases[] = {
+            {std::string(20, '\x0B'), "Hi There", "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7"},
+            {"Jefe", "what do ya want for nothing?", "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"},
+            {std::string(131, '\xAA'), "Test Using Larger Than Block-Size Key - Hash Key First", "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54"}
+        };
+
+        for (const auto& testCase : testCases)
+        {
+            const sha256::Hmac hmac{testCase.key};
+            REQUIRE(toString(hmac.generate(testCase.data)) == testCase.result);
+            REQUIRE(toString(sha256::generateHmac(testCase.data, testCase.key)) == testCase.result);
+            REQUIRE(sha256::verifyHmac(testCase.data, testCase.key, hmac.generate(testCase.data)));
+        }
+    }
+}
+
+TEST_CASE("SHA512", "[sha512]")
+{
+    SECTION("Hash")
+    {
+        const struct final
+        {
+            std::string data;
+            std::string result;
+        } testCases[] = {
+            {"", "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e"},
+            {"abc", "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"},
+            {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+             "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909"},
+            {std::string(128, '\xFF'), "5acaf06f5dd1d107b81b9b7516d454e304cf5699d01ffe66a01ad554cfb0db896bbc16e08bd4fbcab36364909edf50ecb6c8042722a4c59456d9048244cd57f0"}
+        };
+
+        for (const auto& testCase : testCases)
+        {
+            REQUIRE(toString(sha512::hash(testCase.data)) == testCase.result);
+            REQUIRE(toString(sha512::hash(std::list<char>(testCase.data.begin(), testCase.data.end()))) == testCase.result);
+        }
+    }
+
+    SECTION("Incremental")
+    {
+        std::vector<std::uint8_t> data(300);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<std::uint8_t>(i * 7);
+
+        const auto expected = sha512::hash(data);
+
+        sha512::Hasher hasher;
+        for (const std::size_t split : {0, 1, 111, 112, 127, 128, 129, 256, 299, 300})
+        {
+            hasher.update(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(split));
+            hasher.update(data.begin() + static_cast<std::ptrdiff_t>(split), data.end());
+            REQUIRE(hasher.finalize() == expected);
+        }
+    }
+}
+
+TEST_CASE("SHA384", "[sha384]")
+{
+    SECTION("Hash")
+    {
+        const struct final
+        {
+            std::string data;
+            std::string result;
+        } testCases[] = {
+            {"", "38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da274edebfe76f65fbd51ad2f14898b95b"},
+            {"abc", "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7"},
+            {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+             "09330c33f71147e83d192fc782cd1b4753111b173b3b05d22fa08086e3b0f712fcc7c71a557e2db966c3e9fa91746039"},
+            {std::string(128, '\xFF'), "3d34f3f197db8908a16e44f6c38fd8057adef4e3427213011029a9caaa75b5373b66828826eb05eb0383bf140c35db7a"}
+        };
+
+        for (const auto& testCase : testCases)
+        {
+            REQUIRE(toString(sha384::hash(testCase.data)) == testCase.result);
+            REQUIRE(toString(sha384::hash(std::list<char>(testCase.data.begin(), testCase.data.end()))) == testCase.result);
+        }
+    }
+
+    SECTION("Incremental")
+    {
+        std::vector<std::uint8_t> data(300);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<std::uint8_t>(i * 7);
+
+        const auto expected = sha384::hash(data);
+
+        sha384::Hasher hasher;
+        for (const std::size_t split : {0, 1, 111, 112, 127, 128, 129, 256, 299, 300})
+        {
+            hasher.update(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(split));
+            hasher.update(data.begin() + static_cast<std::ptrdiff_t>(split), data.end());
+            REQUIRE(hasher.finalize() == expected);
+        }
+    }
+}
+
+TEST_CASE("SHA512/256", "[sha512_256]")
+{
+    SECTION("Hash")
+    {
+        const struct final
+        {
+            std::string data;
+            std::string result;
+        } testCases[] = {
+            {"", "c672b8d1ef56ed28ab87c3622c5114069bdd3ad7b8f9737498d0c01ecef0967a"},
+            {"abc", "53048e2681941ef99b2e29b76b4c7dabe4c2d0c634fc6d46e0e2f13107e7af23"},
+            {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+             "3928e184fb8690f840da3988121d31be65cb9d3ef83ee6146feac861e19b563a"},
+            {std::string(128, '\xFF'), "a5cd5e13204b9fd3594d8dbc59993fb48f749639e85bdd327c6b7a9268a043e3"}
+        };
+
+        for (const auto& testCase : testCases)
+        {
+            REQUIRE(toString(sha512_256::hash(testCase.data)) == testCase.result);
+            REQUIRE(toString(sha512_256::hash(std::list<char>(testCase.data.begin(), testCase.data.end()))) == testCase.result);
+        }
+    }
+
+    SECTION("Incremental")
+    {
+        std::vector<std::uint8_t> data(300);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<std::uint8_t>(i * 7);
+
+        const auto expected = sha512_256::hash(data);
+
+        sha512_256::Hasher hasher;
+        for (const std::size_t split : {0, 1, 111, 112, 127, 128, 129, 256, 299, 300})
+        {
+            hasher.update(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(split));
+            hasher.update(data.begin() + static_cast<std::ptrdiff_t>(split), data.end());
+            REQUIRE(hasher.finalize() == expected);
+        }
+    }
 }